@@ -99,8 +99,10 @@ rtems_status_code hpsc_rti_timer_start(
     rtems_status_code sc;
     assert(tmr);
     HPSC_RTIT_DBG("RTIT: %s: start\n", tmr->name);
+    if (tmr->is_started)
+        return RTEMS_RESOURCE_IN_USE;
     sc = rtems_interrupt_handler_install(tmr->vec, tmr->name,
-                                         RTEMS_INTERRUPT_UNIQUE, handler, arg);
+                                         RTEMS_INTERRUPT_SHARED, handler, arg);
     if (sc == RTEMS_SUCCESSFUL)
         tmr->is_started = true;
     return sc;
@@ -30,6 +30,10 @@ rtems_status_code hpsc_rti_timer_remove(struct hpsc_rti_timer *tmr);
 
 /**
  * Start a RTI Timer.
+ * The timers of all CPUs may share an interrupt vector (a PPI), in which case
+ * each timer's interrupt calls the handlers of all started timers, on the CPU
+ * whose timer fired, so handlers must check which CPU they run on.
+ * Returns RTEMS_RESOURCE_IN_USE if the timer is already started.
  * May not be called from an interrupt context.
  */
 rtems_status_code hpsc_rti_timer_start(
@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <rtems.h>
@@ -66,9 +67,11 @@ static int do_test(struct link *link)
         .status = CMD_STATUS_UNKNOWN
     };
     struct cmd_test_link *tlink = link->priv;
-    int rc = cmd_enqueue_cb(&cmdt.cmd, handled_cb, &cmdt);
-    if (rc)
-        return rc;
+    int rc = cmd_enqueue_cb(cmd_server_for_link(link), &cmdt.cmd, handled_cb,
+                            &cmdt);
+    if (rc < 0)
+        return 1;
+    rc = 0;
 
     // wait for reply
     while (!tlink->is_write)
@@ -86,6 +89,55 @@ static int do_test(struct link *link)
     return cmdt.status == CMD_STATUS_SUCCESS ? rc : 1;
 }
 
+// PING is answered on receipt if its handler is ISR-safe, without queueing
+static int do_test_fast_path(struct link *link)
+{
+    struct cmd cmd = {
+        .msg = { PING, 0 },
+        .link = link
+    };
+    struct cmd_server *s = cmd_server_for_link(link);
+    struct cmd_test_link *tlink = link->priv;
+    int rc = 0;
+    if (!(cmd_get_flags(s, PING) & CMD_FLAG_ISR_SAFE))
+        return 0; // server has no fast path for PING
+    tlink->is_write = false;
+    tlink->reply_sz = 0;
+    if (!cmd_handle_isr(s, &cmd))
+        return 1;
+    // reply is written before returning
+    if (!tlink->is_write || ((uint8_t *)tlink->reply)[0] != PONG)
+        rc = 1;
+    link_ack(link);
+    return rc;
+}
+
+// a fast path reply whose ACK is lost holds the link only until it's stale
+static int do_test_lost_ack(struct link *link)
+{
+    struct cmd cmd = {
+        .msg = { PING, 0 },
+        .link = link
+    };
+    struct cmd_server *s = cmd_server_for_link(link);
+    if (!(cmd_get_flags(s, PING) & CMD_FLAG_ISR_SAFE))
+        return 0; // server has no fast path for PING
+    if (!cmd_handle_isr(s, &cmd))
+        return 1;
+    // no ACK
+    if (cmd_handle_isr(s, &cmd) || link_tx_release_stale(link, 1000)) {
+        printf("ERROR: TEST: command: claim released early\n");
+        return 1;
+    }
+    rtems_task_wake_after(2);
+    if (!link_tx_release_stale(link, 1) || !link_tx_claim(link)) {
+        printf("ERROR: TEST: command: stale claim not released\n");
+        return 1;
+    }
+    link_tx_release(link);
+    return 0;
+}
+
 // test command handler using a dummy link implementation
 int hpsc_test_command_server(void)
 {
@@ -95,12 +147,11 @@ int hpsc_test_command_server(void)
         .reply = &reply,
         .reply_sz = 0
     };
-    struct link link = {
-        .name = "Command Test Link",
-        .priv = &tlink,
-        .write = test_link_write,
-        .read = test_link_read,
-        .close = test_link_close
-    };
-    return do_test(&link);
+    struct link link;
+    link_init(&link, "Command Test Link", &tlink);
+    link.write = test_link_write;
+    link.read = test_link_read;
+    link.close = test_link_close;
+    return do_test(&link) || do_test_fast_path(&link) ||
+           do_test_lost_ack(&link);
 }
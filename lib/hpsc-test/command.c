@@ -6,10 +6,12 @@
 
 // libhpsc
 #include <command.h>
+#include <hpsc-msg.h>
 
 #include "hpsc-test.h"
 
 #define CMD_TEST_TIMEOUT_TICKS 100
+#define CMD_TEST_QUEUE_LEN 2
 
 struct cmd_test_ctx {
     struct cmd cmd;
@@ -21,11 +23,17 @@ struct cmd_test_ctx {
 #define TEST_EVENT_CMD_CB RTEMS_EVENT_0
 #define TEST_EVENT_CB     RTEMS_EVENT_1
 
+// commands are identified by their first payload byte, in the order handled
+static uint8_t handled_ids[CMD_TEST_QUEUE_LEN * CMD_PRIO_CLASSES];
+static size_t handled_count;
+
 static ssize_t cmd_test_handler(struct cmd *cmd, void *reply, size_t reply_sz)
 {
     assert(cmd);
     assert(reply);
     assert(reply_sz);
+    if (handled_count < RTEMS_ARRAY_SIZE(handled_ids))
+        handled_ids[handled_count++] = cmd->msg[HPSC_MSG_PAYLOAD_OFFSET];
     return 0; // no reply (there's no link to reply with)
 }
 
@@ -45,56 +53,126 @@ static void handled_cb(void *arg, cmd_status status)
     rtems_event_send(cmdt->tid, TEST_EVENT_CB);
 }
 
-static int do_test(rtems_id task_id)
+// fill the queue without a handler task to drain it
+static int do_test_backpressure(void)
+{
+    struct cmd cmd = {
+        .msg = { 0 },
+        .link = NULL
+    };
+    struct cmd_server *s;
+    int rc = 1;
+    s = cmd_server_create(1, CMD_TEST_QUEUE_LEN, CMD_TEST_QUEUE_LEN);
+    if (!s)
+        return 1;
+    if (cmd_enqueue(s, &cmd) == 0 &&
+        cmd_enqueue(s, &cmd) == CMD_ENQUEUE_HIGH_WATERMARK &&
+        cmd_enqueue(s, &cmd) < 0 &&
+        cmd_drop_all(s) == CMD_TEST_QUEUE_LEN &&
+        cmd_enqueue(s, &cmd) == 0 &&
+        cmd_drop_all(s) == 1)
+        rc = 0;
+    if (cmd_server_destroy(s) != RTEMS_SUCCESSFUL)
+        rc = 1;
+    return rc;
+}
+
+static int do_test(struct cmd_server *s, rtems_id task_id)
 {
     rtems_status_code sc;
     rtems_event_set events = 0;
+    struct cmd_type_stats stats_before;
+    struct cmd_type_stats stats;
+    struct cmd_latency lat;
     int rc = 1;
+    // queued before the handler starts: the high priority command must be
+    // handled first, and the one with a short deadline must expire
+    struct cmd low = {
+        .msg = { NOP, 0, 0, 0, 1 },
+        .prio = CMD_PRIO_LOW
+    };
+    struct cmd high = {
+        .msg = { NOP, 0, 0, 0, 2 },
+        .prio = CMD_PRIO_HIGH
+    };
+    struct cmd expiring = {
+        .msg = { NOP, 0, 0, 0, 3 },
+        .deadline_ticks = 1
+    };
     struct cmd_test_ctx cmdt = {
         .cmd = {
             .msg = { 0 },
             .link = NULL,
+            .prio = CMD_PRIO_LOW
         },
         .tid = rtems_task_self(),
         .handled_cmd = false,
         .status = CMD_STATUS_UNKNOWN
     };
 
+    // register the handler for our command's type, there's no default handler
+    sc = cmd_register(s, NOP, cmd_test_handler, 0);
+    if (sc != RTEMS_SUCCESSFUL) {
+        rtems_task_delete(task_id);
+        return 1;
+    }
+    cmd_get_stats(s, NOP, &stats_before);
+
     // register "handled" callback
-    cmd_handled_register_cb(handled_cb, &cmdt);
+    cmd_handled_register_cb(s, handled_cb, &cmdt);
+
+    handled_count = 0;
+    if (cmd_enqueue(s, &low) < 0 || cmd_enqueue(s, &high) < 0 ||
+        cmd_enqueue(s, &expiring) < 0) {
+        rtems_task_delete(task_id);
+        goto unregister;
+    }
+    rtems_task_wake_after(2);
 
     // start the command handle task
-    sc = cmd_handle_task_start(task_id, cmd_test_handler, /* ticks */ 0);
+    sc = cmd_handle_tasks_start(s, &task_id, NULL, /* ticks */ 0);
     if (sc != RTEMS_SUCCESSFUL) {
         rtems_task_delete(task_id);
         goto unregister;
     }
 
     // enqueue a command and wait for handler to process it
-    rc = cmd_enqueue_cb(&cmdt.cmd, handled_cmd_cb, &cmdt);
-    if (rc)
+    rc = cmd_enqueue_cb(s, &cmdt.cmd, handled_cmd_cb, &cmdt);
+    if (rc < 0)
         goto stop_task;
+    rc = 0;
     rtems_event_receive(TEST_EVENT_CMD_CB | TEST_EVENT_CB, RTEMS_EVENT_ALL,
                         CMD_TEST_TIMEOUT_TICKS, &events);
 
     // check results
-    if (cmdt.status != CMD_STATUS_SUCCESS || !cmdt.handled_cmd)
+    cmd_get_stats(s, NOP, &stats);
+    cmd_get_latency(s, NOP, &lat);
+    if (cmdt.status != CMD_STATUS_SUCCESS || !cmdt.handled_cmd ||
+        stats.count != stats_before.count + 3 ||
+        stats.expired != stats_before.expired + 1 ||
+        handled_count != 3 || handled_ids[0] != 2 || handled_ids[1] != 1 ||
+        handled_ids[2] != 0 ||
+        lat.stage[CMD_LATENCY_TOTAL].count != 3 ||
+        !lat.stage[CMD_TS_ENQUEUE].count)
         rc = 1;
 
 stop_task:
-    sc = cmd_handle_task_destroy();
+    sc = cmd_handle_tasks_destroy(s);
     if (sc != RTEMS_SUCCESSFUL)
         rc = 1;
 unregister:
-    cmd_handled_unregister_cb();
+    cmd_handled_unregister_cb(s);
+    cmd_unregister(s, NOP);
     return rc;
 }
 
 int hpsc_test_command(void)
 {
+    struct cmd_server *s;
     rtems_status_code sc;
     rtems_id task_id;
     rtems_name task_name = rtems_build_name('C','M','D','H');
+    int rc;
     // create the command handle task
     sc = rtems_task_create(
         task_name, 1, RTEMS_MINIMUM_STACK_SIZE, RTEMS_DEFAULT_MODES,
@@ -102,5 +180,18 @@ int hpsc_test_command(void)
     );
     if (sc != RTEMS_SUCCESSFUL)
         rtems_panic("hpsc_test_command: %s", rtems_status_text(sc));
-    return do_test(task_id);
+    if (do_test_backpressure()) {
+        rtems_task_delete(task_id);
+        return 1;
+    }
+    // our own server, independent of any the application is running
+    s = cmd_server_create(1, CMD_TEST_QUEUE_LEN, 0);
+    if (!s) {
+        rtems_task_delete(task_id);
+        return 1;
+    }
+    rc = do_test(s, task_id);
+    if (cmd_server_destroy(s) != RTEMS_SUCCESSFUL)
+        rc = 1;
+    return rc;
 }
@@ -0,0 +1,221 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <file-xfer.h>
+#include <hpsc-msg.h>
+#include <mem-access.h>
+
+#include "hpsc-test.h"
+
+#define TEST_DIR "/hpsc-test-file-xfer"
+#define TEST_FILE TEST_DIR "/data"
+#define TEST_FILE_SIZE 1200
+#define TEST_BUF_SIZE 600
+
+static uint8_t buf[TEST_BUF_SIZE] __attribute__((aligned(sizeof(uint32_t))));
+
+static uint8_t test_byte(uint32_t offset)
+{
+    return offset * 7;
+}
+
+static int read_file(uint8_t op, uint8_t handle, const char *path,
+                     uint32_t offset, uint32_t len, uint32_t b,
+                     uint8_t status, struct hpsc_msg_read_value_payload *out)
+{
+    HPSC_MSG_DEFINE(msg);
+    HPSC_MSG_DEFINE(reply);
+    struct hpsc_msg_read_file_payload *req = hpsc_msg_read_file_encode(msg);
+    const struct hpsc_msg_read_value_payload *rep;
+    req->op = op;
+    req->handle = handle;
+    if (path) {
+        strcpy(req->path, path);
+    } else {
+        req->xfer.offset = offset;
+        req->xfer.len = len;
+        req->xfer.buf = b;
+    }
+    if (file_xfer_read_file(NULL, msg, reply, sizeof(reply)) !=
+            sizeof(reply)) {
+        printf("ERROR: TEST: file_xfer: READ_FILE: no reply\n");
+        return 1;
+    }
+    rep = hpsc_msg_read_value_decode(reply);
+    if (!rep || rep->id != READ_FILE || rep->status != status) {
+        printf("ERROR: TEST: file_xfer: READ_FILE: bad reply\n");
+        return 1;
+    }
+    if (out)
+        *out = *rep;
+    return 0;
+}
+
+static int write_file(uint8_t op, uint8_t handle, uint8_t flags,
+                      const char *path, uint32_t offset, uint32_t len,
+                      uint32_t b, uint8_t status,
+                      struct hpsc_msg_write_status_payload *out)
+{
+    HPSC_MSG_DEFINE(msg);
+    HPSC_MSG_DEFINE(reply);
+    struct hpsc_msg_write_file_payload *req = hpsc_msg_write_file_encode(msg);
+    const struct hpsc_msg_write_status_payload *rep;
+    uint32_t i;
+    req->op = op;
+    req->handle = handle;
+    req->flags = flags;
+    if (path) {
+        strcpy(req->path, path);
+    } else {
+        req->xfer.offset = offset;
+        req->xfer.len = len;
+        req->xfer.buf = b;
+        for (i = 0; !b && i < len && i < sizeof(req->data); i++)
+            req->data[i] = test_byte(offset + i);
+    }
+    if (file_xfer_write_file(NULL, msg, reply, sizeof(reply)) !=
+            sizeof(reply)) {
+        printf("ERROR: TEST: file_xfer: WRITE_FILE: no reply\n");
+        return 1;
+    }
+    rep = hpsc_msg_write_status_decode(reply);
+    if (!rep || rep->id != WRITE_FILE || rep->status != status) {
+        printf("ERROR: TEST: file_xfer: WRITE_FILE: bad reply\n");
+        return 1;
+    }
+    if (out)
+        *out = *rep;
+    return 0;
+}
+
+static int check(const uint8_t *data, uint32_t offset, uint32_t len)
+{
+    uint32_t i;
+    for (i = 0; i < len; i++) {
+        if (data[i] != test_byte(offset + i)) {
+            printf("ERROR: TEST: file_xfer: bad data at offset %u\n",
+                   (unsigned) (offset + i));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int do_test_write(void)
+{
+    struct hpsc_msg_write_status_payload ws;
+    uint32_t b = (uint32_t)(uintptr_t) buf;
+    uint32_t offset;
+    uint32_t len;
+    uint32_t i;
+    uint8_t h;
+    if (write_file(FILE_OP_OPEN, 0, HPSC_MSG_FILE_CREATE | HPSC_MSG_FILE_TRUNC,
+                   TEST_FILE, 0, 0, 0, FILE_STATUS_OK, &ws))
+        return 1;
+    h = ws.handle;
+    // the first half inline, the second from a buffer
+    for (offset = 0; offset < TEST_FILE_SIZE - TEST_BUF_SIZE;
+         offset += ws.len) {
+        len = TEST_FILE_SIZE - TEST_BUF_SIZE - offset;
+        if (len > HPSC_MSG_FILE_WRITE_INLINE_SIZE)
+            len = HPSC_MSG_FILE_WRITE_INLINE_SIZE;
+        if (write_file(FILE_OP_XFER, h, 0, NULL, offset, len, 0,
+                       FILE_STATUS_OK, &ws) ||
+            ws.len != len)
+            return 1;
+    }
+    // too large to be inline
+    if (write_file(FILE_OP_XFER, h, 0, NULL, offset, TEST_BUF_SIZE, 0,
+                   FILE_STATUS_INVALID, NULL))
+        return 1;
+    for (i = 0; i < TEST_BUF_SIZE; i++)
+        buf[i] = test_byte(offset + i);
+    if (write_file(FILE_OP_XFER, h, 0, NULL, offset, TEST_BUF_SIZE, b,
+                   FILE_STATUS_OK, &ws) ||
+        ws.len != TEST_BUF_SIZE)
+        return 1;
+    return write_file(FILE_OP_CLOSE, h, 0, NULL, 0, 0, 0, FILE_STATUS_OK,
+                      NULL);
+}
+
+static int do_test_read(void)
+{
+    struct hpsc_msg_read_value_payload rv;
+    uint32_t b = (uint32_t)(uintptr_t) buf;
+    uint32_t offset;
+    uint8_t h;
+    if (read_file(FILE_OP_OPEN, 0, TEST_FILE, 0, 0, 0, FILE_STATUS_OK, &rv))
+        return 1;
+    if (rv.len != TEST_FILE_SIZE) {
+        printf("ERROR: TEST: file_xfer: bad file size\n");
+        return 1;
+    }
+    h = rv.handle;
+    // inline, until the empty read at the end of the file
+    offset = 0;
+    do {
+        if (read_file(FILE_OP_XFER, h, NULL, offset, TEST_FILE_SIZE, 0,
+                      FILE_STATUS_OK, &rv) ||
+            rv.offset != offset || check(rv.data, offset, rv.len))
+            return 1;
+        offset += rv.len;
+    } while (rv.len);
+    if (offset != TEST_FILE_SIZE) {
+        printf("ERROR: TEST: file_xfer: bad read size\n");
+        return 1;
+    }
+    // resume mid-file into a buffer: short at the end of the chunk
+    memset(buf, 0, sizeof(buf));
+    offset = FILE_XFER_CHUNK_SIZE / 2;
+    if (read_file(FILE_OP_XFER, h, NULL, offset, TEST_BUF_SIZE, b,
+                  FILE_STATUS_OK, &rv) ||
+        rv.len != FILE_XFER_CHUNK_SIZE / 2 || check(buf, offset, rv.len))
+        return 1;
+    // rejects
+    if (read_file(FILE_OP_XFER, h + 1, NULL, 0, 1, 0, FILE_STATUS_INVALID,
+                  NULL) ||
+        read_file(FILE_OP_OPEN, 0, TEST_DIR "/../data", 0, 0, 0,
+                  FILE_STATUS_DENIED, NULL) ||
+        read_file(FILE_OP_OPEN, 0, TEST_DIR "-other", 0, 0, 0,
+                  FILE_STATUS_DENIED, NULL) ||
+        read_file(FILE_OP_OPEN, 0, TEST_DIR "/none", 0, 0, 0,
+                  FILE_STATUS_NOT_FOUND, NULL))
+        return 1;
+    return read_file(FILE_OP_CLOSE, h, NULL, 0, 0, 0, FILE_STATUS_OK, NULL);
+}
+
+int hpsc_test_file_xfer(void)
+{
+    rtems_status_code sc;
+    int rc = 1;
+    if (mkdir(TEST_DIR, 0755) && errno != EEXIST) {
+        printf("ERROR: TEST: file_xfer: mkdir\n");
+        return 1;
+    }
+    sc = file_xfer_allow(TEST_DIR, FILE_XFER_READ | FILE_XFER_WRITE);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printf("ERROR: TEST: file_xfer: allow\n");
+        goto rmdir;
+    }
+    sc = mem_access_allow((uintptr_t) buf, sizeof(buf),
+                          MEM_ACCESS_READ | MEM_ACCESS_WRITE);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printf("ERROR: TEST: file_xfer: mem access allow\n");
+        goto revoke;
+    }
+    rc = do_test_write() || do_test_read();
+    unlink(TEST_FILE);
+    mem_access_revoke((uintptr_t) buf, sizeof(buf));
+revoke:
+    file_xfer_revoke(TEST_DIR);
+rmdir:
+    rmdir(TEST_DIR);
+    return rc;
+}
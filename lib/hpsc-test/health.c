@@ -0,0 +1,78 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <health.h>
+
+#include "hpsc-test.h"
+
+#define TEST_PERIOD_TICKS 2
+
+// not a CPU's group, so being late doesn't stop a WDT from being kicked
+static struct health_group group;
+
+static int do_test(struct health_task *t)
+{
+    struct health_task *tasks[HEALTH_TASKS_MAX];
+    struct health_stats stats;
+    size_t n;
+    size_t i;
+    bool full;
+    if (!health_check(&group)) {
+        printf("ERROR: TEST: health: unhealthy on registration\n");
+        return 1;
+    }
+    rtems_task_wake_after(TEST_PERIOD_TICKS * 2);
+    if (health_check(&group)) {
+        printf("ERROR: TEST: health: healthy when late\n");
+        return 1;
+    }
+    health_check_in(t);
+    if (!health_check(&group)) {
+        printf("ERROR: TEST: health: unhealthy after check in\n");
+        return 1;
+    }
+    if (health_get_stats(&group, &stats, 1) != 1 ||
+        stats.period != TEST_PERIOD_TICKS || stats.min_slack >= 0 ||
+        stats.misses != 1) {
+        printf("ERROR: TEST: health: bad stats\n");
+        return 1;
+    }
+    // fill the group
+    for (n = 0; n < HEALTH_TASKS_MAX - 1; n++) {
+        tasks[n] = health_register(&group, "test fill", TEST_PERIOD_TICKS);
+        if (!tasks[n])
+            break;
+    }
+    full = n == HEALTH_TASKS_MAX - 1 &&
+        !health_register(&group, "test full", TEST_PERIOD_TICKS);
+    for (i = 0; i < n; i++)
+        health_unregister(tasks[i]);
+    if (!full) {
+        printf("ERROR: TEST: health: capacity\n");
+        return 1;
+    }
+    return 0;
+}
+
+int hpsc_test_health(void)
+{
+    struct health_stats stats;
+    struct health_task *t;
+    int rc;
+    t = health_register(&group, "test", TEST_PERIOD_TICKS);
+    if (!t) {
+        printf("ERROR: TEST: health: register\n");
+        return 1;
+    }
+    rc = do_test(t);
+    health_unregister(t);
+    if (health_get_stats(&group, &stats, 1) || !health_check(&group)) {
+        printf("ERROR: TEST: health: not empty\n");
+        rc = 1;
+    }
+    return rc;
+}
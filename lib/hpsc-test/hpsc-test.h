@@ -4,14 +4,22 @@
 #include <rtems.h>
 
 // libhpsc
+#include <doorbell.h>
 #include <link.h>
 
 // the following tests have no dependencies
 int hpsc_test_command(void);
+int hpsc_test_file_xfer(void);
+int hpsc_test_health(void);
+int hpsc_test_mem_access(void);
+int hpsc_test_prop_store(void);
 int hpsc_test_shmem(void);
+int hpsc_test_shmem_arena(void);
+int hpsc_test_shmem_bcast(void);
+int hpsc_test_telemetry(void);
 
-// the following tests require "command" to be configured with a server to
-// respond to PING requests
+// the following tests require "command" to be configured with a default server
+// to respond to PING requests
 int hpsc_test_command_server(void);
 // the link may be local (loopback) or remote
 int hpsc_test_link_ping(struct link *link, rtems_interval wtimeout_ticks,
@@ -20,5 +28,10 @@ int hpsc_test_link_ping(struct link *link, rtems_interval wtimeout_ticks,
 int hpsc_test_link_shmem(rtems_interval wtimeout_ticks,
                          rtems_interval rtimeout_ticks,
                          rtems_event_set event_wait);
+// the doorbells must ring each other, and the test takes ownership of them
+int hpsc_test_link_shmem_doorbell(struct doorbell *sdb, struct doorbell *cdb,
+                                  rtems_interval wtimeout_ticks,
+                                  rtems_interval rtimeout_ticks,
+                                  rtems_event_set event_wait);
 
 #endif // HPSC_TEST_H
@@ -7,6 +7,7 @@
 
 // libhpsc
 #include <command.h>
+#include <doorbell.h>
 #include <link.h>
 #include <link-shmem.h>
 #include <shmem.h>
@@ -24,15 +25,18 @@ static int do_test(struct link *slink, struct link *clink,
                    rtems_event_set event_wait)
 {
     // command is sent by client and received by server
+    struct cmd_server *s = cmd_server_for_link(slink);
     int rc;
     cmd_status status = CMD_STATUS_UNKNOWN;
 
-    cmd_handled_register_cb(handled_cb, &status);
+    if (!s)
+        return 1;
+    cmd_handled_register_cb(s, handled_cb, &status);
     rc = hpsc_test_link_ping(clink, wtimeout_ticks, rtimeout_ticks, event_wait);
     // wait for command handler to finish, o/w we prematurely destroy the link
     while (status == CMD_STATUS_UNKNOWN)
         rtems_task_wake_after(RTEMS_YIELD_PROCESSOR);
-    cmd_handled_unregister_cb();
+    cmd_handled_unregister_cb(s);
     return status == CMD_STATUS_SUCCESS ? rc : 1;
 }
 
@@ -47,42 +51,52 @@ static void create_poll_task(rtems_name name, rtems_id *id)
         rtems_panic("create_poll_task: %s", rtems_status_text(sc));
 }
 
-// test link-shmem (requires command handler to be configured)
-int hpsc_test_link_shmem(rtems_interval wtimeout_ticks,
-                         rtems_interval rtimeout_ticks,
-                         rtems_event_set event_wait)
+static int test_link_shmem(struct doorbell *sdb, struct doorbell *cdb,
+                           rtems_interval wtimeout_ticks,
+                           rtems_interval rtimeout_ticks,
+                           rtems_event_set event_wait)
 {
     struct hpsc_shmem_region reg_a = { 0 };
     struct hpsc_shmem_region reg_b = { 0 };
-    rtems_id stid_recv;
-    rtems_id stid_ack;
-    rtems_id ctid_recv;
-    rtems_id ctid_ack;
+    rtems_id stid_recv = RTEMS_ID_NONE;
+    rtems_id stid_ack = RTEMS_ID_NONE;
+    rtems_id ctid_recv = RTEMS_ID_NONE;
+    rtems_id ctid_ack = RTEMS_ID_NONE;
     struct link *slink;
     struct link *clink;
     int rc;
 
-    create_poll_task(rtems_build_name('T','C','S','R'), &stid_recv);
-    create_poll_task(rtems_build_name('T','C','S','A'), &stid_ack);
+    if (!sdb) {
+        create_poll_task(rtems_build_name('T','C','S','R'), &stid_recv);
+        create_poll_task(rtems_build_name('T','C','S','A'), &stid_ack);
+    }
     slink = link_shmem_connect("Shmem Link Test Server",
                                (uintptr_t) &reg_a, (uintptr_t) &reg_b,
-                               true, 1, stid_recv, stid_ack);
+                               SHMEM_MODE_UNCACHED, true, 1, stid_recv,
+                               stid_ack, sdb);
     if (!slink) {
         // manually cleanup resources for tasks that may not have been started
-        rtems_task_delete(stid_recv);
-        rtems_task_delete(stid_ack);
+        if (!sdb) {
+            rtems_task_delete(stid_recv);
+            rtems_task_delete(stid_ack);
+        }
         return 1;
     }
-    create_poll_task(rtems_build_name('T','C','C','R'), &ctid_recv);
-    create_poll_task(rtems_build_name('T','C','C','A'), &ctid_ack);
+    if (!cdb) {
+        create_poll_task(rtems_build_name('T','C','C','R'), &ctid_recv);
+        create_poll_task(rtems_build_name('T','C','C','A'), &ctid_ack);
+    }
     clink = link_shmem_connect("Shmem Link Test Client",
                                (uintptr_t) &reg_b, (uintptr_t) &reg_a,
-                               false, 1, ctid_recv, ctid_ack);
+                               SHMEM_MODE_UNCACHED, false, 1, ctid_recv,
+                               ctid_ack, cdb);
     if (!clink) {
         rc = 1;
         // manually cleanup resources for tasks that may not have been started
-        rtems_task_delete(ctid_recv);
-        rtems_task_delete(ctid_ack);
+        if (!cdb) {
+            rtems_task_delete(ctid_recv);
+            rtems_task_delete(ctid_ack);
+        }
         goto free_slink;
     }
 
@@ -96,3 +110,24 @@ free_slink:
 
     return rc;
 }
+
+// test link-shmem (requires command handler to be configured)
+int hpsc_test_link_shmem(rtems_interval wtimeout_ticks,
+                         rtems_interval rtimeout_ticks,
+                         rtems_event_set event_wait)
+{
+    return test_link_shmem(NULL, NULL, wtimeout_ticks, rtimeout_ticks,
+                           event_wait);
+}
+
+// test link-shmem with doorbells (requires command handler to be configured)
+int hpsc_test_link_shmem_doorbell(struct doorbell *sdb, struct doorbell *cdb,
+                                  rtems_interval wtimeout_ticks,
+                                  rtems_interval rtimeout_ticks,
+                                  rtems_event_set event_wait)
+{
+    assert(sdb);
+    assert(cdb);
+    return test_link_shmem(sdb, cdb, wtimeout_ticks, rtimeout_ticks,
+                           event_wait);
+}
@@ -0,0 +1,157 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <hpsc-msg.h>
+#include <mem-access.h>
+
+#include "hpsc-test.h"
+
+#define TEST_MEM_SIZE 64
+
+static uint8_t mem[TEST_MEM_SIZE] __attribute__((aligned(sizeof(uint32_t))));
+static uint8_t bulk[TEST_MEM_SIZE] __attribute__((aligned(sizeof(uint32_t))));
+static uint8_t denied[TEST_MEM_SIZE];
+
+static size_t bulk_copies;
+
+static int test_copy(void *dest, const void *src, size_t sz, void *arg)
+{
+    bulk_copies++;
+    memcpy(dest, src, sz);
+    return 0;
+}
+
+static int read_addr(uint32_t buf, const struct hpsc_msg_mem_seg *segs,
+                     uint32_t nsegs, uint32_t status, uint32_t len,
+                     const void *data)
+{
+    HPSC_MSG_DEFINE(msg);
+    HPSC_MSG_DEFINE(reply);
+    struct hpsc_msg_read_addr_payload *req = hpsc_msg_read_addr_encode(msg);
+    const struct hpsc_msg_read_value_payload *rep;
+    req->buf = buf;
+    req->nsegs = nsegs;
+    memcpy(req->segs, segs, nsegs * sizeof(*segs));
+    if (mem_access_read_addr(msg, reply, sizeof(reply)) != sizeof(reply)) {
+        printf("ERROR: TEST: mem_access: READ_ADDR: no reply\n");
+        return 1;
+    }
+    rep = hpsc_msg_read_value_decode(reply);
+    if (!rep || rep->status != status || rep->len != len ||
+        (data && memcmp(buf ? (void *)(uintptr_t) buf : (void *) rep->data,
+                        data, len))) {
+        printf("ERROR: TEST: mem_access: READ_ADDR: bad reply\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int write_addr(uint32_t buf, const struct hpsc_msg_mem_seg *segs,
+                      uint32_t nsegs, const void *data, uint32_t status,
+                      uint32_t len)
+{
+    HPSC_MSG_DEFINE(msg);
+    HPSC_MSG_DEFINE(reply);
+    struct hpsc_msg_write_addr_payload *req = hpsc_msg_write_addr_encode(msg);
+    const struct hpsc_msg_write_status_payload *rep;
+    req->buf = buf;
+    req->nsegs = nsegs;
+    memcpy(req->segs, segs, nsegs * sizeof(*segs));
+    if (data)
+        memcpy(req->inl.data, data, segs[0].len);
+    if (mem_access_write_addr(msg, reply, sizeof(reply)) != sizeof(reply)) {
+        printf("ERROR: TEST: mem_access: WRITE_ADDR: no reply\n");
+        return 1;
+    }
+    rep = hpsc_msg_write_status_decode(reply);
+    if (!rep || rep->status != status || rep->len != len) {
+        printf("ERROR: TEST: mem_access: WRITE_ADDR: bad reply\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int do_test(void)
+{
+    uint32_t m = (uint32_t)(uintptr_t) mem;
+    uint32_t b = (uint32_t)(uintptr_t) bulk;
+    // the first two are contiguous, so are coalesced into one copy
+    struct hpsc_msg_mem_seg segs[] = {
+        { m + 32, 16 }, { m + 48, 16 }, { m, 4 }
+    };
+    struct hpsc_msg_mem_seg seg_denied = {
+        (uint32_t)(uintptr_t) denied, 4
+    };
+    struct hpsc_msg_mem_seg seg_overflow = { m, UINT32_MAX };
+    uint8_t expected[36];
+    size_t i;
+    for (i = 0; i < TEST_MEM_SIZE; i++)
+        mem[i] = i;
+    memcpy(expected, &mem[32], 32);
+    memcpy(&expected[32], mem, 4);
+
+    // inline
+    if (read_addr(0, segs, 3, MEM_STATUS_OK, sizeof(expected), expected))
+        return 1;
+    // bulk, into another allowed region
+    if (read_addr(b, segs, 3, MEM_STATUS_OK, sizeof(expected), expected))
+        return 1;
+    if (bulk_copies != 1) {
+        printf("ERROR: TEST: mem_access: bulk copies: %zu\n", bulk_copies);
+        return 1;
+    }
+    // inline write, read back
+    if (write_addr(0, &segs[2], 1, "\xa5\xa5\xa5\xa5", MEM_STATUS_OK, 4) ||
+        read_addr(0, &segs[2], 1, MEM_STATUS_OK, 4, "\xa5\xa5\xa5\xa5"))
+        return 1;
+    // bulk write from another allowed region
+    memset(bulk, 0x5a, 32);
+    if (write_addr(b, segs, 2, NULL, MEM_STATUS_OK, 32) ||
+        memcmp(&mem[32], bulk, 32))
+        return 1;
+    // rejects
+    if (read_addr(0, &seg_denied, 1, MEM_STATUS_DENIED, 0, NULL) ||
+        read_addr(0, &seg_overflow, 1, MEM_STATUS_INVALID, 0, NULL) ||
+        read_addr(0, segs, 0, MEM_STATUS_INVALID, 0, NULL) ||
+        read_addr((uint32_t)(uintptr_t) denied, segs, 3, MEM_STATUS_DENIED, 0,
+                  NULL) ||
+        write_addr(0, segs, 2, NULL, MEM_STATUS_INVALID, 0))
+        return 1;
+    return 0;
+}
+
+int hpsc_test_mem_access(void)
+{
+    mem_access_copy_t copy;
+    void *copy_arg;
+    size_t copy_min_sz;
+    rtems_status_code sc;
+    int rc;
+    bulk_copies = 0;
+    sc = mem_access_allow((uintptr_t) mem, sizeof(mem),
+                          MEM_ACCESS_READ | MEM_ACCESS_WRITE);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printf("ERROR: TEST: mem_access: allow\n");
+        return 1;
+    }
+    sc = mem_access_allow((uintptr_t) bulk, sizeof(bulk),
+                          MEM_ACCESS_READ | MEM_ACCESS_WRITE);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printf("ERROR: TEST: mem_access: allow\n");
+        mem_access_revoke((uintptr_t) mem, sizeof(mem));
+        return 1;
+    }
+    // replaces the app's copier, if any, while the test runs
+    mem_access_get_bulk_copy(&copy, &copy_arg, &copy_min_sz);
+    mem_access_set_bulk_copy(test_copy, NULL, 32);
+    rc = do_test();
+    mem_access_set_bulk_copy(copy, copy_arg, copy_min_sz);
+    mem_access_revoke((uintptr_t) bulk, sizeof(bulk));
+    mem_access_revoke((uintptr_t) mem, sizeof(mem));
+    return rc;
+}
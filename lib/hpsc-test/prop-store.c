@@ -0,0 +1,149 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <hpsc-msg.h>
+#include <prop-store.h>
+
+#include "hpsc-test.h"
+
+#define TEST_PROPS 3
+
+static int read_prop(const uint32_t *ids, uint8_t count, uint8_t status,
+                     const uint8_t *types, const uint32_t *values)
+{
+    HPSC_MSG_DEFINE(msg);
+    HPSC_MSG_DEFINE(reply);
+    struct hpsc_msg_read_prop_payload *req = hpsc_msg_read_prop_encode(msg);
+    const struct hpsc_msg_read_value_payload *rep;
+    unsigned i;
+    req->count = count;
+    for (i = 0; i < count; i++)
+        req->ids[i] = ids[i];
+    if (prop_store_read_prop(msg, reply, sizeof(reply)) != sizeof(reply)) {
+        printf("ERROR: TEST: prop_store: READ_PROP: no reply\n");
+        return 1;
+    }
+    rep = hpsc_msg_read_value_decode(reply);
+    if (!rep || rep->id != READ_PROP || rep->status != status) {
+        printf("ERROR: TEST: prop_store: READ_PROP: bad reply\n");
+        return 1;
+    }
+    for (i = 0; types && i < count; i++) {
+        if (rep->props.types[i] != types[i] ||
+            rep->props.values[i] != values[i]) {
+            printf("ERROR: TEST: prop_store: READ_PROP: bad property %u\n",
+                   i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int write_prop(const uint32_t *ids, const uint8_t *types,
+                      const uint32_t *values, uint8_t count, uint8_t status,
+                      uint32_t len)
+{
+    HPSC_MSG_DEFINE(msg);
+    HPSC_MSG_DEFINE(reply);
+    struct hpsc_msg_write_prop_payload *req = hpsc_msg_write_prop_encode(msg);
+    const struct hpsc_msg_write_status_payload *rep;
+    unsigned i;
+    req->count = count;
+    // an oversize count is sent with only the test properties filled in
+    for (i = 0; i < count && i < TEST_PROPS; i++) {
+        req->types[i] = types[i];
+        req->props[i].id = ids[i];
+        req->props[i].value = values[i];
+    }
+    if (prop_store_write_prop(msg, reply, sizeof(reply)) != sizeof(reply)) {
+        printf("ERROR: TEST: prop_store: WRITE_PROP: no reply\n");
+        return 1;
+    }
+    rep = hpsc_msg_write_status_decode(reply);
+    if (!rep || rep->id != WRITE_PROP || rep->status != status ||
+        rep->len != len) {
+        printf("ERROR: TEST: prop_store: WRITE_PROP: bad reply\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int do_test(const uint32_t *ids)
+{
+    uint32_t missing[] = { ids[0], hpsc_msg_prop_id("hpsc-test.none") };
+    uint8_t types[] = { PROP_TYPE_U32, PROP_TYPE_I32, PROP_TYPE_BOOL };
+    uint8_t missing_types[] = { PROP_TYPE_U32, PROP_TYPE_NONE };
+    uint32_t missing_values[] = { 1, 0 };
+    uint32_t values[] = { 1, -2, 1 };
+    uint32_t new_values[] = { 0, 7, 0 };
+    uint32_t value;
+
+    // one round trip for all
+    if (read_prop(ids, TEST_PROPS, PROP_STATUS_OK, types, values))
+        return 1;
+    if (read_prop(missing, 2, PROP_STATUS_NOT_FOUND, missing_types,
+                  missing_values))
+        return 1;
+    // writable ones, then the read-only one
+    if (write_prop(&ids[1], &types[1], &new_values[1], 2, PROP_STATUS_OK, 2) ||
+        write_prop(ids, types, new_values, 1, PROP_STATUS_DENIED, 0))
+        return 1;
+    values[1] = new_values[1];
+    values[2] = new_values[2];
+    if (read_prop(ids, TEST_PROPS, PROP_STATUS_OK, types, values))
+        return 1;
+    // rejects: wrong type, invalid value, too many
+    value = 2;
+    if (write_prop(&ids[2], &types[1], &value, 1, PROP_STATUS_INVALID, 0) ||
+        write_prop(&ids[2], &types[2], &value, 1, PROP_STATUS_INVALID, 0) ||
+        read_prop(ids, 0, PROP_STATUS_INVALID, NULL, NULL) ||
+        write_prop(ids, types, values, HPSC_MSG_PROP_WRITES_MAX + 1,
+                   PROP_STATUS_INVALID, 0))
+        return 1;
+    // local counter updates
+    if (prop_store_add(ids[0], 2) != RTEMS_SUCCESSFUL ||
+        prop_store_get(ids[0], &value) != PROP_TYPE_U32 || value != 3 ||
+        prop_store_add(ids[2], 1) == RTEMS_SUCCESSFUL) {
+        printf("ERROR: TEST: prop_store: add\n");
+        return 1;
+    }
+    return 0;
+}
+
+int hpsc_test_prop_store(void)
+{
+    uint32_t ids[TEST_PROPS] = {
+        hpsc_msg_prop_id("hpsc-test.counter"),
+        hpsc_msg_prop_id("hpsc-test.offset"),
+        hpsc_msg_prop_id("hpsc-test.enabled")
+    };
+    rtems_status_code sc;
+    int rc = 1;
+    unsigned i;
+    sc = prop_store_register(ids[0], PROP_TYPE_U32, 0, 1);
+    if (sc != RTEMS_SUCCESSFUL)
+        goto out;
+    sc = prop_store_register(ids[1], PROP_TYPE_I32, PROP_STORE_WRITABLE,
+                             (uint32_t) -2);
+    if (sc != RTEMS_SUCCESSFUL)
+        goto out;
+    sc = prop_store_register(ids[2], PROP_TYPE_BOOL, PROP_STORE_WRITABLE, 1);
+    if (sc != RTEMS_SUCCESSFUL)
+        goto out;
+    if (prop_store_register(ids[2], PROP_TYPE_BOOL, 0, 0) !=
+            RTEMS_RESOURCE_IN_USE) {
+        printf("ERROR: TEST: prop_store: registered twice\n");
+        goto out;
+    }
+    rc = do_test(ids);
+out:
+    if (sc != RTEMS_SUCCESSFUL)
+        printf("ERROR: TEST: prop_store: register\n");
+    for (i = 0; i < TEST_PROPS; i++)
+        prop_store_unregister(ids[i]);
+    return rc;
+}
@@ -0,0 +1,126 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <shmem-arena.h>
+
+#include "hpsc-test.h"
+
+#define TEST_REGION_SIZE 4096
+#define TEST_NUM_PORTS 1
+
+static const struct shmem_arena_class classes[] = {
+    { .order = 6, .count = 8 },
+    { .order = 10, .count = 1 },
+    { .order = 8, .count = 4 },
+};
+
+static int do_test(struct shmem_arena *a, uintptr_t addr)
+{
+    volatile struct hpsc_shmem_arena_hdr *hdr =
+        (volatile struct hpsc_shmem_arena_hdr *) addr;
+    void *bufs[8];
+    void *buf;
+    uint32_t offset;
+    size_t i;
+
+    // exhaust the smallest class, checking alignment
+    for (i = 0; i < RTEMS_ARRAY_SIZE(bufs); i++) {
+        bufs[i] = shmem_arena_alloc(a, 48);
+        if (!bufs[i] || ((uintptr_t) bufs[i] % 64) ||
+            shmem_arena_buf_size(a, bufs[i]) != 64) {
+            printf("ERROR: TEST: shmem_arena: alloc failed\n");
+            return 1;
+        }
+    }
+    // should fall back to the next larger class
+    buf = shmem_arena_alloc(a, 64);
+    if (!buf || shmem_arena_buf_size(a, buf) != 256) {
+        printf("ERROR: TEST: shmem_arena: alloc fallback failed\n");
+        return 1;
+    }
+    shmem_arena_free(a, buf);
+    // too large for any class
+    if (shmem_arena_alloc(a, 2048)) {
+        printf("ERROR: TEST: shmem_arena: oversized alloc succeeded\n");
+        return 1;
+    }
+
+    // free locally and reallocate
+    shmem_arena_free(a, bufs[0]);
+    bufs[0] = shmem_arena_alloc(a, 64);
+    if (!bufs[0] || shmem_arena_buf_size(a, bufs[0]) != 64) {
+        printf("ERROR: TEST: shmem_arena: realloc failed\n");
+        return 1;
+    }
+
+    // return remotely, which is allocated again only once reclaimed
+    offset = shmem_arena_to_offset(a, bufs[1]);
+    if (shmem_arena_from_offset(a, offset) != bufs[1]) {
+        printf("ERROR: TEST: shmem_arena: offset translation failed\n");
+        return 1;
+    }
+    if (shmem_arena_return(addr, TEST_NUM_PORTS, offset) == 0) {
+        printf("ERROR: TEST: shmem_arena: return to bad port succeeded\n");
+        return 1;
+    }
+    if (shmem_arena_return(addr, 0, offset)) {
+        printf("ERROR: TEST: shmem_arena: return failed\n");
+        return 1;
+    }
+    buf = shmem_arena_alloc(a, 64);
+    if (!buf || shmem_arena_buf_size(a, buf) != 256) {
+        printf("ERROR: TEST: shmem_arena: alloc before reclaim failed\n");
+        return 1;
+    }
+    shmem_arena_free(a, buf);
+    if (shmem_arena_reclaim(a) != 1 || shmem_arena_alloc(a, 64) != bufs[1]) {
+        printf("ERROR: TEST: shmem_arena: reclaim failed\n");
+        return 1;
+    }
+
+    // bad returns are dropped: a misaligned offset, and a buffer returned twice
+    if (shmem_arena_return(addr, 0, offset + 4) ||
+        shmem_arena_return(addr, 0, offset) ||
+        shmem_arena_return(addr, 0, offset) ||
+        shmem_arena_reclaim(a) != 3) {
+        printf("ERROR: TEST: shmem_arena: bad returns failed\n");
+        return 1;
+    }
+    bufs[1] = shmem_arena_alloc(a, 64);
+    buf = shmem_arena_alloc(a, 64);
+    if (!bufs[1] || !buf || shmem_arena_buf_size(a, buf) != 256) {
+        printf("ERROR: TEST: shmem_arena: bad returns reclaimed\n");
+        return 1;
+    }
+    shmem_arena_free(a, buf);
+    // a corrupt head is resynced rather than walked
+    hdr->ports[0].head += 1000;
+    if (shmem_arena_reclaim(a) != 0 ||
+        hdr->ports[0].tail != hdr->ports[0].head) {
+        printf("ERROR: TEST: shmem_arena: bad head not resynced\n");
+        return 1;
+    }
+
+    for (i = 0; i < RTEMS_ARRAY_SIZE(bufs); i++)
+        shmem_arena_free(a, bufs[i]);
+    return 0;
+}
+
+int hpsc_test_shmem_arena(void)
+{
+    // a dummy shared memory region, aligned to the largest class
+    static uint8_t region[TEST_REGION_SIZE] RTEMS_ALIGNED(1024);
+    struct shmem_arena *a;
+    int rc;
+
+    a = shmem_arena_create((uintptr_t) region, sizeof(region), classes,
+                           RTEMS_ARRAY_SIZE(classes), TEST_NUM_PORTS);
+    if (!a)
+        return 1;
+    rc = do_test(a, (uintptr_t) region);
+    shmem_arena_destroy(a);
+    return rc;
+}
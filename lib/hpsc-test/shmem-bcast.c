@@ -0,0 +1,120 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <hpsc-msg.h>
+#include <shmem-bcast.h>
+
+#include "hpsc-test.h"
+
+// room for a header and one extra slot, which is rounded down
+#define TEST_NUM_SLOTS 4
+#define TEST_REGION_SIZE \
+    (sizeof(struct hpsc_shmem_bcast_hdr) + \
+     (TEST_NUM_SLOTS + 1) * sizeof(struct hpsc_shmem_bcast_slot))
+
+// each message carries its sequence number in the first payload byte
+static int publish(struct shmem_bcast *b, uint32_t first, uint32_t count)
+{
+    HPSC_MSG_DEFINE(msg);
+    uint32_t i;
+    msg[0] = PING;
+    for (i = first; i < first + count; i++) {
+        msg[HPSC_MSG_PAYLOAD_OFFSET] = i;
+        // short writes are zero-padded
+        if (shmem_bcast_publish(b, msg, HPSC_MSG_SIZE - 1) != i) {
+            printf("ERROR: TEST: shmem_bcast: bad sequence number\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int expect(struct shmem_bcast_reader *r, const char *name,
+                  uint32_t first, uint32_t count, uint32_t lost_expected)
+{
+    HPSC_MSG_DEFINE(msg);
+    uint32_t lost;
+    uint32_t i;
+    for (i = first; i < first + count; i++) {
+        msg[HPSC_MSG_SIZE - 1] = 0xff;
+        if (shmem_bcast_read(r, msg, sizeof(msg), &lost) != HPSC_MSG_SIZE) {
+            printf("ERROR: TEST: shmem_bcast: %s: read failed\n", name);
+            return 1;
+        }
+        if (msg[0] != PING || msg[HPSC_MSG_PAYLOAD_OFFSET] != i ||
+            msg[HPSC_MSG_SIZE - 1]) {
+            printf("ERROR: TEST: shmem_bcast: %s: bad message\n", name);
+            return 1;
+        }
+        if (lost != (i == first ? lost_expected : 0)) {
+            printf("ERROR: TEST: shmem_bcast: %s: lost: %"PRIu32"\n", name,
+                   lost);
+            return 1;
+        }
+    }
+    if (shmem_bcast_read(r, msg, sizeof(msg), &lost)) {
+        printf("ERROR: TEST: shmem_bcast: %s: read extra message\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+static int do_test(struct shmem_bcast *b, uintptr_t addr)
+{
+    struct shmem_bcast_reader *fast;
+    struct shmem_bcast_reader *slow;
+    struct shmem_bcast_reader *late;
+    int rc = 1;
+
+    fast = shmem_bcast_reader_open(addr);
+    if (!fast)
+        return 1;
+    slow = shmem_bcast_reader_open(addr);
+    if (!slow)
+        goto free_fast;
+    late = NULL;
+
+    // readers consume independently, at their own pace
+    if (publish(b, 1, 3) || expect(fast, "fast", 1, 3, 0))
+        goto free_readers;
+    // the slow reader is lapped and skips to the oldest available message
+    if (publish(b, 4, TEST_NUM_SLOTS) ||
+        expect(fast, "fast", 4, TEST_NUM_SLOTS, 0) ||
+        expect(slow, "slow", 4, TEST_NUM_SLOTS, 3))
+        goto free_readers;
+    // a new reader only sees new messages
+    late = shmem_bcast_reader_open(addr);
+    if (!late)
+        goto free_readers;
+    if (publish(b, 8, 1) || expect(late, "late", 8, 1, 0) ||
+        expect(slow, "slow", 8, 1, 0) || expect(fast, "fast", 8, 1, 0))
+        goto free_readers;
+    rc = 0;
+
+free_readers:
+    if (late)
+        shmem_bcast_reader_close(late);
+    shmem_bcast_reader_close(slow);
+free_fast:
+    shmem_bcast_reader_close(fast);
+    return rc;
+}
+
+int hpsc_test_shmem_bcast(void)
+{
+    // a dummy shared memory region
+    static uint8_t region[TEST_REGION_SIZE] RTEMS_ALIGNED(8);
+    struct shmem_bcast *b;
+    int rc;
+
+    b = shmem_bcast_create((uintptr_t) region, sizeof(region), NULL);
+    if (!b)
+        return 1;
+    rc = do_test(b, (uintptr_t) region);
+    shmem_bcast_destroy(b);
+    return rc;
+}
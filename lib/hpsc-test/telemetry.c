@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// libhpsc
+#include <hpsc-msg.h>
+#include <telemetry.h>
+
+#include "hpsc-test.h"
+
+#define TEST_TEXT_SIZE 128
+
+static int check(const void *msg, const char *expected)
+{
+    char text[TEST_TEXT_SIZE];
+    char small[8];
+    int len = telemetry_snprint(text, sizeof(text), msg);
+    if (len < 0 || strcmp(text, expected)) {
+        printf("ERROR: TEST: telemetry: decoded: %s\n", len < 0 ? "" : text);
+        return 1;
+    }
+    // truncated like snprintf
+    if (telemetry_snprint(small, sizeof(small), msg) != len ||
+        strncmp(small, expected, sizeof(small) - 1) ||
+        small[sizeof(small) - 1]) {
+        printf("ERROR: TEST: telemetry: truncated\n");
+        return 1;
+    }
+    return 0;
+}
+
+int hpsc_test_telemetry(void)
+{
+    HPSC_MSG_DEFINE(msg);
+    const struct hpsc_msg_telemetry_payload *p;
+    uint32_t fields[] = { 100, 7 };
+    char expected[TEST_TEXT_SIZE];
+
+    hpsc_msg_telemetry(msg, sizeof(msg), TELEMETRY_EVENT_LIFECYCLE,
+                       LIFECYCLE_UP, TELEMETRY_STR_RTPS_R52, fields, 2);
+    p = hpsc_msg_telemetry_decode(msg);
+    if (!p || p->event != TELEMETRY_EVENT_LIFECYCLE ||
+        p->status != LIFECYCLE_UP || p->str != TELEMETRY_STR_RTPS_R52 ||
+        p->nfields != 2 || p->fields[0] != 100 || p->fields[1] != 7) {
+        printf("ERROR: TEST: telemetry: bad payload\n");
+        return 1;
+    }
+    if (check(msg, "lifecycle status=0 \"RTPS R52\" uptime_ticks=100 "
+                   "drivers_us=7"))
+        return 1;
+    // fields past the named ones are numbered
+    hpsc_msg_telemetry(msg, sizeof(msg), TELEMETRY_EVENT_NONE, 0,
+                       TELEMETRY_STR_NONE, fields, 2);
+    if (check(msg, "none status=0 f0=100 f1=7"))
+        return 1;
+    // IDs from a newer table are still decoded, as numbers
+    hpsc_msg_telemetry(msg, sizeof(msg), TELEMETRY_EVENT_COUNT, 1,
+                       TELEMETRY_STR_COUNT, NULL, 0);
+    snprintf(expected, sizeof(expected), "event %u status=1 str=%u",
+             TELEMETRY_EVENT_COUNT, TELEMETRY_STR_COUNT);
+    if (check(msg, expected))
+        return 1;
+    hpsc_msg_ping(msg, sizeof(msg), NULL, 0);
+    if (telemetry_snprint(NULL, 0, msg) != -1) {
+        printf("ERROR: TEST: telemetry: decoded a PING\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+
+#include "boot-time.h"
+
+static struct boot_time_mark marks[BOOT_TIME_MARKS_MAX];
+static size_t num_marks = 0;
+
+void boot_time_mark(const char *name)
+{
+    if (num_marks == BOOT_TIME_MARKS_MAX)
+        return;
+    marks[num_marks].name = name;
+    marks[num_marks].ns = rtems_clock_get_uptime_nanoseconds();
+    num_marks++;
+}
+
+uint32_t boot_time_us(const char *name)
+{
+    size_t i = num_marks;
+    while (i--)
+        if (!strcmp(marks[i].name, name))
+            return marks[i].ns / 1000;
+    return 0;
+}
+
+size_t boot_time_get(const struct boot_time_mark **m)
+{
+    *m = marks;
+    return num_marks;
+}
+
+void boot_time_print(void)
+{
+    uint64_t prev_ns = 0;
+    size_t i;
+    printf("Boot time:\n");
+    for (i = 0; i < num_marks; i++) {
+        printf("%10"PRIu64" us: +%10"PRIu64" us: %s\n", marks[i].ns / 1000,
+               (marks[i].ns - prev_ns) / 1000, marks[i].name);
+        prev_ns = marks[i].ns;
+    }
+    if (num_marks == BOOT_TIME_MARKS_MAX)
+        printf("(later marks dropped)\n");
+}
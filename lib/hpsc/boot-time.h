@@ -0,0 +1,41 @@
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Boot profiler: the boot sequence marks the end of each phase (e.g., a driver
+// probe or a group of tasks started) with the uptime in nanoseconds, so the
+// time to service after reset can be broken down.
+// Not synchronized, marks must be made by one task at a time, as during boot.
+
+#define BOOT_TIME_MARKS_MAX 32 // later marks are dropped
+
+struct boot_time_mark {
+    const char *name;
+    uint64_t ns; // uptime at the end of the phase
+};
+
+/**
+ * Mark the end of a phase, which began at the previous mark (or at boot).
+ * The name isn't copied, so must outlive the profile.
+ */
+void boot_time_mark(const char *name);
+
+/**
+ * Get the uptime of the (last) mark with a name, in microseconds, or 0 if not
+ * marked.
+ */
+uint32_t boot_time_us(const char *name);
+
+/**
+ * Get the marks, in order, returning how many.
+ */
+size_t boot_time_get(const struct boot_time_mark **marks);
+
+/**
+ * Print the marks and each phase's duration to stdout.
+ */
+void boot_time_print(void);
+
+#endif // BOOT_TIME_H
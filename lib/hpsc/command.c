@@ -1,17 +1,21 @@
 #include <assert.h>
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <rtems.h>
 #include <rtems/bspIo.h>
+#include <rtems/counter.h>
 
 #include "command.h"
+#include "health.h"
 #include "link.h"
 #include "hpsc-msg.h"
-
-#define CMDQ_LEN 4
+#include "task-join.h"
 
 #define CMD_EVENT_NEW  RTEMS_EVENT_0
 #define CMD_EVENT_EXIT RTEMS_EVENT_1
@@ -23,99 +27,467 @@ struct cmd_handled_ctx {
 };
 
 struct cmd_handler_ctx {
-    rtems_id tid;
     cmd_handler_t *cb;
     rtems_interval timeout_ticks;
     bool running;
 };
 
-struct cmdq_item {
+// Bounded multi-producer/single-consumer ring (D. Vyukov's design).
+// A slot at position pos is free for the producer that claims pos when its seq
+// equals pos, and holds a command for the consumer when its seq is pos + 1.
+// Producers (often ISRs) claim positions with a CAS on tail, so they never
+// block each other; the consumer handles commands in place in their slots and
+// only then releases them to producers of the next lap.
+struct cmdq_slot {
+    atomic_uint seq;
     struct cmd cmd;
     struct cmd_handled_ctx handled;
+    rtems_interval expires; // absolute, in ticks since boot, or 0 for never
+    bool skip; // a reserved slot whose command was moved to another queue
+    // claimed position, between cmd_reserve and cmd_commit
+    struct cmdq *q;
+    unsigned pos;
+} RTEMS_ALIGNED(CPU_CACHE_LINE_BYTES);
+
+// A reply waiting for the remote's ACK, or, when a previous reply on the same
+// link is still in flight, waiting to be sent.
+struct cmd_reply {
+    uint8_t msg[HPSC_MSG_SIZE];
+    struct link *link;
+    struct cmd_handled_ctx handled;
+    rtems_interval expires; // deadline to be sent and ACKed, or 0 for never
+    bool sent;
+    // of the command being replied to
+    uint8_t cmd_type;
+    rtems_counter_ticks ts[CMD_TS_COUNT];
 };
 
+// replies in flight per worker, dequeueing stops while they're all in use
+#define CMD_REPLIES_MAX 8
+
 struct cmdq {
-    struct cmdq_item q[CMDQ_LEN];
-    rtems_interrupt_lock lock;
-    size_t head;
-    size_t tail;
+    // keep producer and consumer positions on separate cache lines
+    atomic_uint tail RTEMS_ALIGNED(CPU_CACHE_LINE_BYTES);
+    atomic_uint head RTEMS_ALIGNED(CPU_CACHE_LINE_BYTES);
+    struct cmdq_slot *slots;
+    unsigned mask;
+    unsigned hwm;
+};
+
+// Each worker task consumes its own queues, one per priority class, always from
+// the highest class with a command ready. Within a class, commands are handled
+// in arrival order, which is also deadline order for commands that share a
+// relative deadline (e.g., of the same type).
+// Commands are dispatched by link, so each link's commands are handled in order
+// (per class), while different links' commands may be handled in parallel.
+// Replies are sent without waiting for their ACKs, which the worker tracks
+// between commands, so a slow remote doesn't hold up commands from other links.
+struct cmd_worker {
+    struct cmdq q[CMD_PRIO_CLASSES];
+    struct cmd_reply replies[CMD_REPLIES_MAX]; // in the order posted
+    size_t num_replies;
+    struct cmd_server *server;
+    rtems_id tid;
+    struct task_join join;
+    // optional health monitoring, while running
+    struct health_group *health;
+    rtems_interval health_ticks;
+    struct health_task *health_task;
 };
 
-static struct cmdq cmdq = {
-    .lock = RTEMS_INTERRUPT_LOCK_INITIALIZER("Command Queue")
+struct cmd_type_entry {
+    cmd_handler_t *handler;
+    uint32_t flags;
+    enum cmd_prio prio;
+    rtems_interval deadline_ticks;
+    struct cmd_type_stats stats;
+    struct cmd_latency latency;
 };
 
-static struct cmd_handler_ctx cmd_handler = {
-    .tid = RTEMS_ID_NONE,
-    .cb = NULL,
-    // timeout prevents hanging when remotes fail
-    .timeout_ticks = 0,
-    .running = false
+struct cmd_server {
+    struct cmd_worker *workers;
+    size_t num_workers;
+    struct cmd_handler_ctx handler;
+    struct cmd_handled_ctx handled;
+    // indexed by message type, entries without a handler use the default
+    // handler
+    struct cmd_type_entry types[HPSC_MSG_TYPE_COUNT];
+    rtems_interrupt_lock types_lock;
 };
 
-static struct cmd_handled_ctx cmd_handled = {
-    .cb = NULL,
-    .cb_arg = NULL
+// copied into each new server's registry
+static const enum cmd_prio cmd_type_prios[HPSC_MSG_TYPE_COUNT] = {
+    [READ_FILE] = CMD_PRIO_LOW,
+    [WRITE_FILE] = CMD_PRIO_LOW,
+    [READ_ADDR] = CMD_PRIO_LOW,
+    [WRITE_ADDR] = CMD_PRIO_LOW,
+    [WATCHDOG_TIMEOUT] = CMD_PRIO_HIGH,
+    [FAULT] = CMD_PRIO_HIGH,
+    [LIFECYCLE] = CMD_PRIO_HIGH,
+    [TELEMETRY] = CMD_PRIO_HIGH,
 };
 
+// for links that weren't given a server of their own
+static struct cmd_server *cmd_server_default = NULL;
+// the worker a handler task runs, for cmd_check_in
+static __thread struct cmd_worker *cmd_worker_self = NULL;
 
-static size_t cmdq_size_unsafe(void)
+
+// claims the slot at the tail for the caller to fill, or returns NULL if the
+// queue is full
+static struct cmdq_slot *cmdq_claim(struct cmdq *q, unsigned *pos_out)
 {
-    return (cmdq.head >= cmdq.tail) ? (cmdq.head - cmdq.tail) :
-        (CMDQ_LEN - cmdq.tail + cmdq.head);
+    struct cmdq_slot *slot;
+    unsigned pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    int dif;
+    for (;;) {
+        slot = &q->slots[pos & q->mask];
+        dif = (int)(atomic_load_explicit(&slot->seq, memory_order_acquire) -
+                    pos);
+        if (dif == 0) {
+            // on failure, pos is updated to the current tail
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            return NULL; // the consumer hasn't released the slot from last lap
+        } else {
+            // another producer claimed pos
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+    *pos_out = pos;
+    return slot;
 }
 
-static int cmd_enqueue_cb_unsafe(struct cmd *cmd, cmd_handled_t *cb,
-                                 void *cb_arg)
+// hands a claimed slot to the consumer, returns the queue depth
+static unsigned cmdq_publish(struct cmdq *q, struct cmdq_slot *slot,
+                             unsigned pos)
 {
-    assert(cmd);
-    if (cmdq.head + 1 % CMDQ_LEN == cmdq.tail) {
-        printk("command: enqueue failed: queue full\n");
-        return 1;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return pos + 1 - atomic_load_explicit(&q->head, memory_order_relaxed);
+}
+
+// returns the queue depth after enqueueing, or 0 if the queue is full
+static unsigned cmdq_push(struct cmdq *q, struct cmd *cmd, cmd_handled_t *cb,
+                          void *cb_arg, rtems_interval expires)
+{
+    unsigned pos;
+    struct cmdq_slot *slot = cmdq_claim(q, &pos);
+    if (!slot)
+        return 0;
+    memcpy(&slot->cmd, cmd, sizeof(struct cmd));
+    slot->cmd.ts[CMD_TS_ENQUEUE] = rtems_counter_read();
+    slot->handled.cb = cb;
+    slot->handled.cb_arg = cb_arg;
+    slot->expires = expires;
+    slot->skip = false;
+    return cmdq_publish(q, slot, pos);
+}
+
+// only the consumer may call, returns NULL if the next command isn't ready
+static struct cmdq_slot *cmdq_peek(struct cmdq *q)
+{
+    unsigned pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    struct cmdq_slot *slot = &q->slots[pos & q->mask];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1)
+        return NULL;
+    return slot;
+}
+
+// only the consumer may call, after it's done with the slot from cmdq_peek
+static void cmdq_release(struct cmdq *q, struct cmdq_slot *slot)
+{
+    unsigned pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, pos + q->mask + 1, memory_order_release);
+    atomic_store_explicit(&q->head, pos + 1, memory_order_relaxed);
+}
+
+static void cmd_type_stats_update(struct cmd_server *s,
+                                  struct cmd_type_entry *e, bool failed,
+                                  rtems_counter_ticks ticks)
+{
+    rtems_interrupt_lock_context lock_context;
+    uint64_t ns = rtems_counter_ticks_to_nanoseconds(ticks);
+    rtems_interrupt_lock_acquire(&s->types_lock, &lock_context);
+    e->stats.count++;
+    if (failed)
+        e->stats.failed++;
+    e->stats.total_ns += ns;
+    if (ns > e->stats.max_ns)
+        e->stats.max_ns = ns;
+    rtems_interrupt_lock_release(&s->types_lock, &lock_context);
+}
+
+static const char *const cmd_latency_stage_names[CMD_TS_COUNT] = {
+    [CMD_TS_RECV] = "enqueue",
+    [CMD_TS_ENQUEUE] = "queued",
+    [CMD_TS_DEQUEUE] = "dispatch",
+    [CMD_TS_HANDLE_START] = "handler",
+    [CMD_TS_HANDLE_END] = "reply wait",
+    [CMD_TS_REPLY_SEND] = "reply ACK",
+    [CMD_LATENCY_TOTAL] = "total",
+};
+
+const char *cmd_latency_stage_name(unsigned stage)
+{
+    assert(stage < CMD_TS_COUNT);
+    return cmd_latency_stage_names[stage];
+}
+
+static uint64_t cmd_ts_diff_ns(rtems_counter_ticks end,
+                               rtems_counter_ticks start)
+{
+    return rtems_counter_ticks_to_nanoseconds(
+        rtems_counter_difference(end, start));
+}
+
+// records the latencies of a command that was handled, stages with either
+// timestamp missing are skipped
+static void cmd_latency_record(struct cmd_server *s, uint8_t type,
+                               struct link *link,
+                               const rtems_counter_ticks *ts)
+{
+    rtems_interrupt_lock_context lock_context;
+    struct cmd_latency *lat = NULL;
+    unsigned first = CMD_TS_COUNT;
+    unsigned last = 0;
+    unsigned i;
+    uint64_t total;
+    if (type < HPSC_MSG_TYPE_COUNT)
+        lat = &s->types[type].latency;
+    for (i = 0; i < CMD_TS_COUNT; i++) {
+        if (!ts[i])
+            continue;
+        if (first == CMD_TS_COUNT)
+            first = i;
+        last = i;
     }
-    cmdq.head = (cmdq.head + 1) % CMDQ_LEN;
-    memcpy(&cmdq.q[cmdq.head].cmd, cmd, sizeof(struct cmd));
-    cmdq.q[cmdq.head].handled.cb = cb;
-    cmdq.q[cmdq.head].handled.cb_arg = cb_arg;
-    printk("command: enqueue (tail %u head %u): cmd %u arg %u...\n",
-           cmdq.tail, cmdq.head,
-           cmdq.q[cmdq.head].cmd.msg[0],
-           cmdq.q[cmdq.head].cmd.msg[HPSC_MSG_PAYLOAD_OFFSET]);
-    return 0;
+    if (first >= last)
+        return;
+    total = cmd_ts_diff_ns(ts[last], ts[first]);
+    rtems_interrupt_lock_acquire(&s->types_lock, &lock_context);
+    if (lat) {
+        for (i = 0; i < CMD_LATENCY_TOTAL; i++) {
+            if (ts[i] && ts[i + 1])
+                latency_hist_add(&lat->stage[i],
+                                 cmd_ts_diff_ns(ts[i + 1], ts[i]));
+        }
+        latency_hist_add(&lat->stage[CMD_LATENCY_TOTAL], total);
+    }
+    if (link)
+        latency_hist_add(&link->cmd_latency, total);
+    rtems_interrupt_lock_release(&s->types_lock, &lock_context);
 }
 
-static int cmd_dequeue_unsafe(struct cmd *cmd, cmd_handled_t **cb,
-                              void **cb_arg)
+static ssize_t cmd_dispatch(struct cmd_server *s, struct cmd *cmd,
+                            void *reply, size_t reply_sz)
 {
-    assert(cmd);
-    assert(cb);
-    assert(cb_arg);
-    if (cmdq.head == cmdq.tail)
-        return 1;
-    cmdq.tail = (cmdq.tail + 1) % CMDQ_LEN;
-    memcpy(cmd, &cmdq.q[cmdq.tail].cmd, sizeof(struct cmd));
-    *cb = cmdq.q[cmdq.tail].handled.cb;
-    *cb_arg = cmdq.q[cmdq.tail].handled.cb_arg;
-    printk("command: dequeue (tail %u head %u): cmd %u arg %u...\n",
-           cmdq.tail, cmdq.head,
-           cmdq.q[cmdq.tail].cmd.msg[0],
-           cmdq.q[cmdq.tail].cmd.msg[HPSC_MSG_PAYLOAD_OFFSET]);
-    return 0;
+    struct cmd_type_entry *e;
+    ssize_t rc;
+    uint8_t type = hpsc_msg_type(cmd->msg);
+    if (type >= HPSC_MSG_TYPE_COUNT || !s->types[type].handler) {
+        if (!s->handler.cb) {
+            printk("ERROR: command: handle: no handler for cmd %u\n", type);
+            return -1;
+        }
+        cmd->ts[CMD_TS_HANDLE_START] = rtems_counter_read();
+        rc = s->handler.cb(cmd, reply, reply_sz);
+        cmd->ts[CMD_TS_HANDLE_END] = rtems_counter_read();
+        return rc;
+    }
+    e = &s->types[type];
+    cmd->ts[CMD_TS_HANDLE_START] = rtems_counter_read();
+    rc = e->handler(cmd, reply, reply_sz);
+    cmd->ts[CMD_TS_HANDLE_END] = rtems_counter_read();
+    if (!rc && (e->flags & CMD_FLAG_REPLY_EXPECTED)) {
+        printk("ERROR: command: handle: cmd %u requires a reply\n", type);
+        rc = -1;
+    }
+    cmd_type_stats_update(s, e, rc < 0,
+        rtems_counter_difference(cmd->ts[CMD_TS_HANDLE_END],
+                                 cmd->ts[CMD_TS_HANDLE_START]));
+    return rc;
 }
 
-static void cmd_handle(struct cmd *cmd, cmd_handled_t *cb, void *cb_arg)
+static void cmd_handled_notify(struct cmd_server *s, cmd_handled_t *cb,
+                               void *cb_arg, cmd_status status)
+{
+    if (cb)
+        cb(cb_arg, status);
+    if (s->handled.cb)
+        s->handled.cb(s->handled.cb_arg, status);
+}
+
+static rtems_interval cmd_ticks_from_now(rtems_interval ticks)
+{
+    rtems_interval t;
+    if (!ticks)
+        return 0;
+    t = rtems_clock_get_ticks_since_boot() + ticks;
+    return t ? t : 1; // 0 is reserved for never
+}
+
+static bool cmd_expired(rtems_interval expires, rtems_interval now)
+{
+    // signed difference, so tick counter wraparound is harmless
+    return expires && (int32_t)(now - expires) > 0;
+}
+
+static bool cmd_reply_link_busy(struct cmd_worker *w, size_t i)
+{
+    size_t j;
+    for (j = 0; j < i; j++) {
+        if (w->replies[j].link == w->replies[i].link)
+            return true;
+    }
+    return false;
+}
+
+// returns false if the reply couldn't be sent
+static bool cmd_reply_send(struct cmd_worker *w, struct cmd_reply *r)
+{
+    ssize_t rc;
+    printk("command: reply: %s: reply %u arg %u...\n", r->link->name,
+           hpsc_msg_type(r->msg), r->msg[HPSC_MSG_PAYLOAD_OFFSET]);
+    rc = link_send_async(r->link, r->msg, sizeof(r->msg), CMD_EVENT_LINK);
+    // a fast path reply whose ACK never came would hold the link forever
+    if (!rc && w->server->handler.timeout_ticks &&
+        link_tx_release_stale(r->link, w->server->handler.timeout_ticks))
+        rc = link_send_async(r->link, r->msg, sizeof(r->msg), CMD_EVENT_LINK);
+    if (rc < 0) {
+        printk("command: reply: %s: failed to send reply\n", r->link->name);
+        return false;
+    }
+    if (!rc) {
+        // another reply is in flight, we're notified when it's done to retry
+        if (!r->expires)
+            r->expires = cmd_ticks_from_now(w->server->handler.timeout_ticks);
+        return true;
+    }
+    r->ts[CMD_TS_REPLY_SEND] = rtems_counter_read();
+    r->expires = cmd_ticks_from_now(w->server->handler.timeout_ticks);
+    r->sent = true;
+    return true;
+}
+
+static void cmd_reply_done(struct cmd_worker *w, size_t i, cmd_status status)
+{
+    struct cmd_reply *r = &w->replies[i];
+    cmd_handled_t *cb = r->handled.cb;
+    void *cb_arg = r->handled.cb_arg;
+    if (r->sent)
+        link_send_end(r->link);
+    else if (r->expires) // was waiting for the link
+        link_send_cancel(r->link);
+    if (status == CMD_STATUS_SUCCESS)
+        cmd_latency_record(w->server, r->cmd_type, r->link, r->ts);
+    memmove(r, r + 1, (w->num_replies - i - 1) * sizeof(*r));
+    w->num_replies--;
+    cmd_handled_notify(w->server, cb, cb_arg, status);
+}
+
+// completes replies that were ACKed or timed out, and sends replies that were
+// waiting for them
+static void cmd_replies_poll(struct cmd_worker *w)
+{
+    rtems_interval now = rtems_clock_get_ticks_since_boot();
+    struct cmd_reply *r;
+    size_t i = 0;
+    while (i < w->num_replies) {
+        r = &w->replies[i];
+        if (r->sent) {
+            if (link_send_acked(r->link)) {
+                // when the worker noticed, which may be after the ACK arrived
+                r->ts[CMD_TS_REPLY_ACK] = rtems_counter_read();
+                cmd_reply_done(w, i, CMD_STATUS_SUCCESS);
+                continue;
+            }
+            if (cmd_expired(r->expires, now)) {
+                printk("command: reply: %s: timed out waiting for ACK\n",
+                       r->link->name);
+                cmd_reply_done(w, i, CMD_STATUS_REPLY_FAILED);
+                continue;
+            }
+        } else {
+            // retry first, a stale claim on the link may be released now
+            if (!cmd_reply_link_busy(w, i) && !cmd_reply_send(w, r)) {
+                cmd_reply_done(w, i, CMD_STATUS_REPLY_FAILED);
+                continue;
+            }
+            if (!r->sent && cmd_expired(r->expires, now)) {
+                printk("command: reply: %s: timed out waiting for link\n",
+                       r->link->name);
+                cmd_reply_done(w, i, CMD_STATUS_REPLY_FAILED);
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+// returns ticks until the earliest deadline, or RTEMS_NO_TIMEOUT if none,
+// bounded by half the health period, so an idle worker still checks in
+static rtems_interval cmd_replies_timeout(struct cmd_worker *w)
+{
+    rtems_interval now = rtems_clock_get_ticks_since_boot();
+    rtems_interval timeout = RTEMS_NO_TIMEOUT;
+    int32_t left;
+    size_t i;
+    if (w->health_task)
+        timeout = w->health_ticks > 1 ? w->health_ticks / 2 : 1;
+    for (i = 0; i < w->num_replies; i++) {
+        if (!w->replies[i].expires)
+            continue;
+        left = (int32_t)(w->replies[i].expires - now);
+        if (left < 1)
+            left = 1; // let it expire on the next tick
+        if (timeout == RTEMS_NO_TIMEOUT || (rtems_interval) left < timeout)
+            timeout = left;
+    }
+    return timeout;
+}
+
+static void cmd_replies_abort(struct cmd_worker *w)
+{
+    while (w->num_replies)
+        cmd_reply_done(w, 0, CMD_STATUS_REPLY_FAILED);
+}
+
+static void cmd_reply_post(struct cmd_worker *w, struct cmd *cmd,
+                           const void *reply, cmd_handled_t *cb, void *cb_arg)
+{
+    size_t i = w->num_replies;
+    struct cmd_reply *r = &w->replies[i];
+    assert(i < CMD_REPLIES_MAX);
+    memcpy(r->msg, reply, sizeof(r->msg));
+    r->link = cmd->link;
+    r->handled.cb = cb;
+    r->handled.cb_arg = cb_arg;
+    r->expires = 0;
+    r->sent = false;
+    r->cmd_type = hpsc_msg_type(cmd->msg);
+    memcpy(r->ts, cmd->ts, sizeof(r->ts));
+    w->num_replies++;
+    // o/w sent when the link's previous reply completes
+    if (!cmd_reply_link_busy(w, i) && !cmd_reply_send(w, r))
+        cmd_reply_done(w, i, CMD_STATUS_REPLY_FAILED);
+}
+
+static void cmd_handle(struct cmd_worker *w, struct cmd *cmd, cmd_handled_t *cb,
+                       void *cb_arg)
 {
     HPSC_MSG_DEFINE(reply);
+    struct cmd_server *s = w->server;
     ssize_t reply_sz;
-    size_t rc;
     cmd_status status = CMD_STATUS_SUCCESS;
     assert(cmd);
-    assert(cmd_handler.cb);
 
     printk("command: handle: cmd %u arg %u...\n",
-           cmd->msg[0], cmd->msg[HPSC_MSG_PAYLOAD_OFFSET]);
+           hpsc_msg_type(cmd->msg), cmd->msg[HPSC_MSG_PAYLOAD_OFFSET]);
 
-    reply_sz = cmd_handler.cb(cmd, reply, sizeof(reply));
+    reply_sz = cmd_dispatch(s, cmd, reply, sizeof(reply));
     if (reply_sz < 0) {
         printk("ERROR: command: handle: server failed to process request\n");
         status = CMD_STATUS_HANDLER_FAILED;
@@ -126,137 +498,605 @@ static void cmd_handle(struct cmd *cmd, cmd_handled_t *cb, void *cb_arg)
         goto out;
     }
 
-    printk("command: handle: %s: reply %u arg %u...\n", cmd->link->name,
-           reply[0], reply[HPSC_MSG_PAYLOAD_OFFSET]);
-    rc = link_request_send(cmd->link, reply, sizeof(reply),
-                           cmd_handler.timeout_ticks, CMD_EVENT_LINK);
-    if (!rc) {
-        printk("command: handle: %s: failed to send reply\n", cmd->link->name);
-        status = CMD_STATUS_REPLY_FAILED;
-    }
+    // status is reported when the reply is ACKed, or fails
+    cmd_reply_post(w, cmd, reply, cb, cb_arg);
+    return;
 
 out:
-    if (cb)
-        cb(cb_arg, status);
-    if (cmd_handled.cb)
-        cmd_handled.cb(cmd_handled.cb_arg, status);
+    if (status == CMD_STATUS_SUCCESS)
+        cmd_latency_record(s, hpsc_msg_type(cmd->msg), cmd->link, cmd->ts);
+    cmd_handled_notify(s, cb, cb_arg, status);
 }
 
-void cmd_handled_register_cb(cmd_handled_t *cb, void *cb_arg)
+static void cmd_expire(struct cmd_server *s, struct cmd *cmd, cmd_handled_t *cb,
+                       void *cb_arg)
 {
-    cmd_handled.cb = cb;
-    cmd_handled.cb_arg = cb_arg;
+    rtems_interrupt_lock_context lock_context;
+    uint8_t type = hpsc_msg_type(cmd->msg);
+    printk("command: expired: cmd %u arg %u...\n", type,
+           cmd->msg[HPSC_MSG_PAYLOAD_OFFSET]);
+    if (type < HPSC_MSG_TYPE_COUNT) {
+        rtems_interrupt_lock_acquire(&s->types_lock, &lock_context);
+        s->types[type].stats.expired++;
+        rtems_interrupt_lock_release(&s->types_lock, &lock_context);
+    }
+    cmd_handled_notify(s, cb, cb_arg, CMD_STATUS_EXPIRED);
 }
 
-void cmd_handled_unregister_cb(void)
+void cmd_handled_register_cb(struct cmd_server *s, cmd_handled_t *cb,
+                             void *cb_arg)
 {
-    cmd_handled.cb = NULL;
-    cmd_handled.cb_arg = NULL;
+    assert(s);
+    s->handled.cb = cb;
+    s->handled.cb_arg = cb_arg;
 }
 
-int cmd_enqueue_cb(struct cmd *cmd, cmd_handled_t *cb, void *cb_arg)
+void cmd_handled_unregister_cb(struct cmd_server *s)
+{
+    assert(s);
+    s->handled.cb = NULL;
+    s->handled.cb_arg = NULL;
+}
+
+rtems_status_code cmd_register(struct cmd_server *s, enum hpsc_msg_type type,
+                               cmd_handler_t *handler, uint32_t flags)
+{
+    assert(s);
+    assert(handler);
+    if (type >= HPSC_MSG_TYPE_COUNT)
+        return RTEMS_INVALID_NUMBER;
+    if (s->types[type].handler)
+        return RTEMS_RESOURCE_IN_USE;
+    s->types[type].flags = flags;
+    s->types[type].handler = handler;
+    return RTEMS_SUCCESSFUL;
+}
+
+void cmd_unregister(struct cmd_server *s, enum hpsc_msg_type type)
+{
+    assert(s);
+    assert(type < HPSC_MSG_TYPE_COUNT);
+    s->types[type].handler = NULL;
+    s->types[type].flags = 0;
+}
+
+void cmd_set_sched(struct cmd_server *s, enum hpsc_msg_type type,
+                   enum cmd_prio prio, rtems_interval deadline_ticks)
+{
+    assert(s);
+    assert(type < HPSC_MSG_TYPE_COUNT);
+    assert(prio <= CMD_PRIO_LOW);
+    s->types[type].prio = prio;
+    s->types[type].deadline_ticks = deadline_ticks;
+}
+
+rtems_status_code cmd_set_health(struct cmd_server *s, size_t worker,
+                                 struct health_group *g,
+                                 rtems_interval period_ticks)
+{
+    assert(s);
+    if (worker >= s->num_workers || (g && !period_ticks))
+        return RTEMS_INVALID_NUMBER;
+    if (s->handler.running)
+        return RTEMS_RESOURCE_IN_USE;
+    s->workers[worker].health = g;
+    s->workers[worker].health_ticks = period_ticks;
+    return RTEMS_SUCCESSFUL;
+}
+
+uint32_t cmd_get_flags(struct cmd_server *s, enum hpsc_msg_type type)
+{
+    assert(s);
+    if (type >= HPSC_MSG_TYPE_COUNT || !s->types[type].handler)
+        return 0;
+    return s->types[type].flags;
+}
+
+void cmd_get_stats(struct cmd_server *s, enum hpsc_msg_type type,
+                   struct cmd_type_stats *stats)
 {
-    int rc;
     rtems_interrupt_lock_context lock_context;
-    rtems_interrupt_lock_acquire(&q.lock, &lock_context);
-    rc = cmd_enqueue_cb_unsafe(cmd, cb, cb_arg);
-    rtems_interrupt_lock_release(&q.lock, &lock_context);
-    if (!rc && cmd_handler.tid != RTEMS_ID_NONE)
-        rc = rtems_event_send(cmd_handler.tid, CMD_EVENT_NEW) != RTEMS_SUCCESSFUL;
-    return rc;
+    assert(s);
+    assert(type < HPSC_MSG_TYPE_COUNT);
+    assert(stats);
+    rtems_interrupt_lock_acquire(&s->types_lock, &lock_context);
+    *stats = s->types[type].stats;
+    rtems_interrupt_lock_release(&s->types_lock, &lock_context);
 }
 
-int cmd_enqueue(struct cmd *cmd)
+void cmd_get_latency(struct cmd_server *s, enum hpsc_msg_type type,
+                     struct cmd_latency *lat)
 {
-    return cmd_enqueue_cb(cmd, NULL, NULL);
+    rtems_interrupt_lock_context lock_context;
+    assert(s);
+    assert(type < HPSC_MSG_TYPE_COUNT);
+    assert(lat);
+    rtems_interrupt_lock_acquire(&s->types_lock, &lock_context);
+    *lat = s->types[type].latency;
+    rtems_interrupt_lock_release(&s->types_lock, &lock_context);
 }
 
-static int cmd_dequeue(struct cmd *cmd, cmd_handled_t **cb, void **cb_arg)
+void cmd_reset_stats(struct cmd_server *s)
 {
-    int rc;
     rtems_interrupt_lock_context lock_context;
-    rtems_interrupt_lock_acquire(&q.lock, &lock_context);
-    rc = cmd_dequeue_unsafe(cmd, cb, cb_arg);
-    rtems_interrupt_lock_release(&q.lock, &lock_context);
-    return rc;
+    size_t i;
+    assert(s);
+    rtems_interrupt_lock_acquire(&s->types_lock, &lock_context);
+    for (i = 0; i < HPSC_MSG_TYPE_COUNT; i++) {
+        memset(&s->types[i].stats, 0, sizeof(s->types[i].stats));
+        memset(&s->types[i].latency, 0, sizeof(s->types[i].latency));
+    }
+    rtems_interrupt_lock_release(&s->types_lock, &lock_context);
 }
 
-static size_t cmd_flush(void)
+static int cmdq_init(struct cmdq *q, unsigned len, size_t hwm)
 {
-    struct cmd cmd;
-    cmd_handled_t *cb;
-    void *cb_arg;
+    unsigned i;
+    q->slots = rtems_cache_aligned_malloc(len * sizeof(*q->slots));
+    if (!q->slots)
+        return -1;
+    for (i = 0; i < len; i++)
+        atomic_init(&q->slots[i].seq, i);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->head, 0);
+    q->mask = len - 1;
+    q->hwm = hwm;
+    return 0;
+}
+
+struct cmd_server *cmd_server_create(size_t n_workers, size_t len, size_t hwm)
+{
+    struct cmd_server *s;
+    struct cmd_worker *w;
+    unsigned n = 1;
+    size_t i;
+    size_t c;
+    assert(n_workers);
+    assert(len && len <= UINT_MAX / 2 + 1);
+    while (n < len)
+        n <<= 1;
+    s = calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    w = rtems_cache_aligned_malloc(n_workers * sizeof(*w));
+    if (!w)
+        goto free_server;
+    for (i = 0; i < n_workers; i++) {
+        for (c = 0; c < CMD_PRIO_CLASSES; c++) {
+            if (cmdq_init(&w[i].q[c], n, hwm))
+                goto free_queues;
+        }
+        w[i].num_replies = 0;
+        w[i].server = s;
+        w[i].tid = RTEMS_ID_NONE;
+        memset(&w[i].join, 0, sizeof(w[i].join)); // not running
+        w[i].health = NULL;
+        w[i].health_ticks = 0;
+        w[i].health_task = NULL;
+    }
+    for (i = 0; i < HPSC_MSG_TYPE_COUNT; i++)
+        s->types[i].prio = cmd_type_prios[i];
+    rtems_interrupt_lock_initialize(&s->types_lock, "Command Types");
+    s->workers = w;
+    s->num_workers = n_workers;
+    printk("command: server: workers %zu len %u hwm %zu\n", n_workers, n, hwm);
+    return s;
+
+free_queues:
+    // free the partially-initialized worker's queues, then all the others
+    while (c--)
+        free(w[i].q[c].slots);
+    while (i--) {
+        for (c = 0; c < CMD_PRIO_CLASSES; c++)
+            free(w[i].q[c].slots);
+    }
+    free(w);
+free_server:
+    free(s);
+    return NULL;
+}
+
+rtems_status_code cmd_server_destroy(struct cmd_server *s)
+{
+    size_t i;
+    size_t c;
+    assert(s);
+    if (s->handler.running)
+        return RTEMS_RESOURCE_IN_USE;
+    if (cmd_server_default == s)
+        cmd_server_default = NULL;
+    for (i = 0; i < s->num_workers; i++) {
+        for (c = 0; c < CMD_PRIO_CLASSES; c++)
+            free(s->workers[i].q[c].slots);
+    }
+    free(s->workers);
+    rtems_interrupt_lock_destroy(&s->types_lock);
+    free(s);
+    return RTEMS_SUCCESSFUL;
+}
+
+void cmd_server_set_default(struct cmd_server *s)
+{
+    cmd_server_default = s;
+}
+
+struct cmd_server *cmd_server_get_default(void)
+{
+    return cmd_server_default;
+}
+
+struct cmd_server *cmd_server_for_link(struct link *link)
+{
+    if (link && link->cmd_server)
+        return link->cmd_server;
+    return cmd_server_default;
+}
+
+static struct cmd_worker *cmd_worker_for(struct cmd_server *s,
+                                         struct link *link)
+{
+    // multiplicative hash, scaled to the number of workers
+    uint32_t h = (uint32_t)(uintptr_t) link * 2654435761u;
+    return &s->workers[((uint64_t) h * s->num_workers) >> 32];
+}
+
+static enum cmd_prio cmd_prio_of(struct cmd_server *s, struct cmd *cmd)
+{
+    uint8_t type = hpsc_msg_type(cmd->msg);
+    if (cmd->prio != CMD_PRIO_DEFAULT)
+        return cmd->prio;
+    if (cmd->link && cmd->link->cmd_prio != CMD_PRIO_DEFAULT)
+        return cmd->link->cmd_prio;
+    if (type < HPSC_MSG_TYPE_COUNT && s->types[type].prio != CMD_PRIO_DEFAULT)
+        return s->types[type].prio;
+    return CMD_PRIO_NORMAL;
+}
+
+static rtems_interval cmd_expires_of(struct cmd_server *s, struct cmd *cmd)
+{
+    uint8_t type = hpsc_msg_type(cmd->msg);
+    rtems_interval ticks = cmd->deadline_ticks;
+    if (!ticks && type < HPSC_MSG_TYPE_COUNT)
+        ticks = s->types[type].deadline_ticks;
+    return cmd_ticks_from_now(ticks);
+}
+
+// wakes the worker after enqueueing, returns as cmd_enqueue_cb
+static int cmd_worker_notify(struct cmd_worker *w, struct cmdq *q,
+                             unsigned depth)
+{
+    if (w->tid != RTEMS_ID_NONE &&
+        rtems_event_send(w->tid, CMD_EVENT_NEW) != RTEMS_SUCCESSFUL)
+        return -1;
+    return (q->hwm && depth >= q->hwm) ? CMD_ENQUEUE_HIGH_WATERMARK : 0;
+}
+
+int cmd_enqueue_cb(struct cmd_server *s, struct cmd *cmd, cmd_handled_t *cb,
+                   void *cb_arg)
+{
+    struct cmd_worker *w;
+    struct cmdq *q;
+    enum cmd_prio prio;
+    unsigned depth;
+    assert(cmd);
+    if (!s) {
+        printk("command: enqueue failed: no server\n");
+        return -1;
+    }
+    w = cmd_worker_for(s, cmd->link);
+    prio = cmd_prio_of(s, cmd);
+    assert(prio > CMD_PRIO_DEFAULT && prio <= CMD_PRIO_LOW);
+    q = &w->q[prio - CMD_PRIO_HIGH];
+    depth = cmdq_push(q, cmd, cb, cb_arg, cmd_expires_of(s, cmd));
+    if (!depth) {
+        printk("command: enqueue failed: queue full\n");
+        return -1;
+    }
+    printk("command: enqueue (worker %zu prio %d depth %u): cmd %u arg %u...\n",
+           (size_t)(w - s->workers), prio, depth, hpsc_msg_type(cmd->msg),
+           cmd->msg[HPSC_MSG_PAYLOAD_OFFSET]);
+    return cmd_worker_notify(w, q, depth);
+}
+
+int cmd_enqueue(struct cmd_server *s, struct cmd *cmd)
+{
+    return cmd_enqueue_cb(s, cmd, NULL, NULL);
+}
+
+struct cmd *cmd_reserve(struct cmd_server *s, struct link *link)
+{
+    struct cmd_worker *w;
+    struct cmdq_slot *slot;
+    struct cmdq *q;
+    enum cmd_prio prio = CMD_PRIO_NORMAL;
+    unsigned pos;
+    if (!s) {
+        printk("command: reserve failed: no server\n");
+        return NULL;
+    }
+    // the message type isn't known until it's read, so assume the class
+    // doesn't depend on it, which cmd_commit fixes if wrong
+    if (link && link->cmd_prio != CMD_PRIO_DEFAULT)
+        prio = link->cmd_prio;
+    w = cmd_worker_for(s, link);
+    q = &w->q[prio - CMD_PRIO_HIGH];
+    slot = cmdq_claim(q, &pos);
+    if (!slot) {
+        printk("command: reserve failed: queue full\n");
+        return NULL;
+    }
+    slot->cmd.link = link;
+    slot->cmd.prio = CMD_PRIO_DEFAULT;
+    slot->cmd.deadline_ticks = 0;
+    memset(slot->cmd.ts, 0, sizeof(slot->cmd.ts));
+    slot->handled.cb = NULL;
+    slot->handled.cb_arg = NULL;
+    slot->skip = false;
+    slot->q = q;
+    slot->pos = pos;
+    return &slot->cmd;
+}
+
+int cmd_commit(struct cmd_server *s, struct cmd *cmd)
+{
+    struct cmdq_slot *slot = (struct cmdq_slot *)
+        ((uint8_t *) cmd - offsetof(struct cmdq_slot, cmd));
+    struct cmd_worker *w;
+    struct cmdq *q;
+    enum cmd_prio prio;
+    unsigned depth;
+    int rc;
+    assert(s);
+    w = cmd_worker_for(s, cmd->link);
+    prio = cmd_prio_of(s, cmd);
+    assert(prio > CMD_PRIO_DEFAULT && prio <= CMD_PRIO_LOW);
+    q = &w->q[prio - CMD_PRIO_HIGH];
+    if (q != slot->q) {
+        // copy to the right class's queue, the worker skips the reserved slot
+        rc = cmd_enqueue(s, cmd);
+        slot->skip = true;
+        cmdq_publish(slot->q, slot, slot->pos);
+        return rc;
+    }
+    slot->expires = cmd_expires_of(s, cmd);
+    cmd->ts[CMD_TS_ENQUEUE] = rtems_counter_read();
+    // the slot is the worker's once published
+    printk("command: commit (worker %zu prio %d): cmd %u arg %u...\n",
+           (size_t)(w - s->workers), prio, hpsc_msg_type(cmd->msg),
+           cmd->msg[HPSC_MSG_PAYLOAD_OFFSET]);
+    depth = cmdq_publish(q, slot, slot->pos);
+    return cmd_worker_notify(w, q, depth);
+}
+
+void cmd_cancel(struct cmd_server *s, struct cmd *cmd)
+{
+    struct cmdq_slot *slot = (struct cmdq_slot *)
+        ((uint8_t *) cmd - offsetof(struct cmdq_slot, cmd));
+    assert(s);
+    // can't un-claim a position other producers may have claimed past, so
+    // leave a hole for the worker to skip
+    slot->skip = true;
+    cmdq_publish(slot->q, slot, slot->pos);
+}
+
+bool cmd_handle_isr(struct cmd_server *s, struct cmd *cmd)
+{
+    HPSC_MSG_DEFINE(reply);
+    struct cmd_type_entry *e;
+    cmd_status status = CMD_STATUS_SUCCESS;
+    ssize_t rc;
+    uint8_t type = hpsc_msg_type(cmd->msg);
+    assert(cmd->link);
+    if (!s || type >= HPSC_MSG_TYPE_COUNT)
+        return false;
+    e = &s->types[type];
+    if (!e->handler || !(e->flags & CMD_FLAG_ISR_SAFE))
+        return false;
+    // claim the link first, so the reply can't be held up by one in flight
+    if (!link_tx_claim(cmd->link))
+        return false;
+
+    cmd->ts[CMD_TS_HANDLE_START] = rtems_counter_read();
+    rc = e->handler(cmd, reply, sizeof(reply));
+    cmd->ts[CMD_TS_HANDLE_END] = rtems_counter_read();
+    if (!rc && (e->flags & CMD_FLAG_REPLY_EXPECTED)) {
+        printk("ERROR: command: fast path: cmd %u requires a reply\n", type);
+        rc = -1;
+    }
+    cmd_type_stats_update(s, e, rc < 0,
+        rtems_counter_difference(cmd->ts[CMD_TS_HANDLE_END],
+                                 cmd->ts[CMD_TS_HANDLE_START]));
+    if (rc <= 0) {
+        link_tx_release(cmd->link);
+        status = rc < 0 ? CMD_STATUS_HANDLER_FAILED : CMD_STATUS_SUCCESS;
+    } else if (!link_send_claimed(cmd->link, reply, sizeof(reply))) {
+        printk("command: fast path: %s: failed to send reply\n",
+               cmd->link->name);
+        status = CMD_STATUS_REPLY_FAILED;
+    } else {
+        cmd->ts[CMD_TS_REPLY_SEND] = rtems_counter_read();
+    }
+    if (status == CMD_STATUS_SUCCESS)
+        cmd_latency_record(s, type, cmd->link, cmd->ts);
+    cmd_handled_notify(s, NULL, NULL, status);
+    return true;
+}
+
+// returns the next command from the highest priority class that has one
+static struct cmdq_slot *cmd_worker_peek(struct cmd_worker *w,
+                                         struct cmdq **q)
+{
+    struct cmdq_slot *slot;
+    size_t c;
+    for (c = 0; c < CMD_PRIO_CLASSES; c++) {
+        slot = cmdq_peek(&w->q[c]);
+        if (slot) {
+            *q = &w->q[c];
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static size_t cmd_flush(struct cmd_worker *w)
+{
+    struct cmdq_slot *slot;
+    struct cmdq *q;
     size_t i = 0;
-    while (!cmd_dequeue(&cmd, &cb, &cb_arg)) {
-        cmd_handle(&cmd, cb, cb_arg);
+    // re-check all classes after each command, so higher classes go first,
+    // and leave the rest queued while all reply slots are in use
+    while (w->num_replies < CMD_REPLIES_MAX &&
+           (slot = cmd_worker_peek(w, &q))) {
+        if (slot->skip) {
+            cmdq_release(q, slot);
+            continue;
+        }
+        slot->cmd.ts[CMD_TS_DEQUEUE] = rtems_counter_read();
+        printk("command: dequeue: cmd %u arg %u...\n",
+               hpsc_msg_type(slot->cmd.msg),
+               slot->cmd.msg[HPSC_MSG_PAYLOAD_OFFSET]);
+        if (cmd_expired(slot->expires, rtems_clock_get_ticks_since_boot()))
+            cmd_expire(w->server, &slot->cmd, slot->handled.cb,
+                       slot->handled.cb_arg);
+        else
+            cmd_handle(w, &slot->cmd, slot->handled.cb, slot->handled.cb_arg);
+        cmdq_release(q, slot);
         i++;
+        if (w->health_task)
+            health_check_in(w->health_task);
     }
     return i;
 }
 
-size_t cmd_drop_all(void)
+size_t cmd_drop_all(struct cmd_server *s)
 {
-    size_t qsize;
-    rtems_interrupt_lock_context lock_context;
-    rtems_interrupt_lock_acquire(&q.lock, &lock_context);
-    qsize = cmdq_size_unsafe();
-    cmdq.tail = cmdq.head;
-    rtems_interrupt_lock_release(&q.lock, &lock_context);
-    return qsize;
+    struct cmdq_slot *slot;
+    struct cmdq *q;
+    size_t i = 0;
+    size_t w;
+    assert(s);
+    for (w = 0; w < s->num_workers; w++) {
+        while ((slot = cmd_worker_peek(&s->workers[w], &q))) {
+            if (!slot->skip)
+                i++;
+            cmdq_release(q, slot);
+        }
+    }
+    return i;
 }
 
-static rtems_task cmd_handle_task(rtems_task_argument ignored)
+void cmd_check_in(void)
 {
+    struct cmd_worker *w = cmd_worker_self;
+    // in an interrupt, this is the interrupted task's
+    if (w && w->health_task && !rtems_interrupt_is_in_progress())
+        health_check_in(w->health_task);
+}
+
+static rtems_task cmd_handle_task(rtems_task_argument arg)
+{
+    struct cmd_worker *w = (struct cmd_worker *) arg;
     rtems_event_set events;
     size_t i = 0;
+    size_t n;
+    cmd_worker_self = w;
     while (1) {
-        printk("[%zu] Waiting for command...\n", i);
-        i += cmd_flush();
+        if (w->health_task)
+            health_check_in(w->health_task);
+        cmd_replies_poll(w);
+        n = cmd_flush(w);
+        // not on every wakeup, which may only be to check in
+        if (n) {
+            i += n;
+            printk("[%zu] Worker %zu waiting for command...\n", i,
+                   (size_t)(w - w->server->workers));
+        }
         events = 0;
-        rtems_event_receive(CMD_EVENT_NEW | CMD_EVENT_EXIT, RTEMS_EVENT_ANY,
-                            RTEMS_NO_TIMEOUT, &events);
+        rtems_event_receive(CMD_EVENT_NEW | CMD_EVENT_EXIT | CMD_EVENT_LINK,
+                            RTEMS_EVENT_ANY, cmd_replies_timeout(w), &events);
         if (events & CMD_EVENT_EXIT)
             // any queued events won't be processed until handler is restarted
             break;
     }
-    cmd_handler.running = false;
-    rtems_task_exit();
+    // links may be destroyed once we've stopped, so stop tracking ACKs
+    cmd_replies_abort(w);
+    cmd_worker_self = NULL;
+    task_join_exit(&w->join);
 }
 
-static void cmd_handler_set(rtems_id tid, cmd_handler_t cb,
+static void cmd_handler_set(struct cmd_server *s, cmd_handler_t cb,
                             rtems_interval timeout_ticks, bool running)
 {
-    cmd_handler.tid = tid;
-    cmd_handler.cb = cb;
-    cmd_handler.timeout_ticks = timeout_ticks;
-    cmd_handler.running = running;
+    s->handler.cb = cb;
+    s->handler.timeout_ticks = timeout_ticks;
+    s->handler.running = running;
 }
 
-rtems_status_code cmd_handle_task_start(rtems_id task_id, cmd_handler_t cb,
-                                        rtems_interval timeout_ticks)
+static void cmd_workers_stop(struct cmd_server *s)
 {
-    rtems_status_code sc;
-    assert(task_id != RTEMS_ID_NONE);
-    assert(cb);
-    if (cmd_handler.running)
-        return RTEMS_UNSATISFIED;
-    cmd_handler_set(task_id, cb, timeout_ticks, true);
-    sc = rtems_task_start(cmd_handler.tid, cmd_handle_task, 1);
-    if (sc != RTEMS_SUCCESSFUL)
-        cmd_handler_set(RTEMS_ID_NONE, NULL, 0, false);
-    return sc;
+    struct cmd_worker *w;
+    size_t i;
+    for (i = 0; i < s->num_workers; i++) {
+        w = &s->workers[i];
+        if (task_join_is_running(&w->join)) {
+            if (rtems_event_send(w->tid, CMD_EVENT_EXIT) == RTEMS_SUCCESSFUL)
+                task_join_wait(&w->join);
+            else
+                task_join_abandon(&w->join);
+        }
+        w->tid = RTEMS_ID_NONE;
+        if (w->health_task) {
+            health_unregister(w->health_task);
+            w->health_task = NULL;
+        }
+    }
 }
 
-rtems_status_code cmd_handle_task_destroy(void)
+rtems_status_code cmd_handle_tasks_start(struct cmd_server *s,
+                                         const rtems_id *task_ids,
+                                         cmd_handler_t cb,
+                                         rtems_interval timeout_ticks)
 {
-    rtems_status_code sc = RTEMS_NOT_DEFINED;
-    if (cmd_handler.running) {
-        sc = rtems_event_send(cmd_handler.tid, CMD_EVENT_EXIT);
-        if (sc == RTEMS_SUCCESSFUL) {
-            while (cmd_handler.running) // wait for task to finish
-                rtems_task_wake_after(RTEMS_YIELD_PROCESSOR);
-            cmd_handler_set(RTEMS_ID_NONE, NULL, 0, false);
+    rtems_status_code sc = RTEMS_SUCCESSFUL;
+    struct cmd_worker *w;
+    size_t i;
+    assert(s);
+    assert(task_ids);
+    if (s->handler.running)
+        return RTEMS_UNSATISFIED;
+    cmd_handler_set(s, cb, timeout_ticks, true);
+    for (i = 0; i < s->num_workers; i++) {
+        assert(task_ids[i] != RTEMS_ID_NONE);
+        w = &s->workers[i];
+        if (w->health) {
+            w->health_task = health_register(w->health, "cmd worker",
+                                             w->health_ticks);
+            if (!w->health_task) {
+                sc = RTEMS_TOO_MANY;
+                cmd_workers_stop(s);
+                cmd_handler_set(s, NULL, 0, false);
+                break;
+            }
+        }
+        w->tid = task_ids[i];
+        sc = task_join_start(&w->join, task_ids[i], cmd_handle_task,
+                             (rtems_task_argument) w);
+        if (sc != RTEMS_SUCCESSFUL) {
+            w->tid = RTEMS_ID_NONE;
+            cmd_workers_stop(s);
+            cmd_handler_set(s, NULL, 0, false);
+            break;
         }
     }
     return sc;
 }
+
+rtems_status_code cmd_handle_tasks_destroy(struct cmd_server *s)
+{
+    assert(s);
+    if (!s->handler.running)
+        return RTEMS_NOT_DEFINED;
+    cmd_workers_stop(s);
+    cmd_handler_set(s, NULL, 0, false);
+    return RTEMS_SUCCESSFUL;
+}
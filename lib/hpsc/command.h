@@ -1,71 +1,294 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <unistd.h>
 
 #include <rtems.h>
+#include <rtems/counter.h>
 
+#include "health.h"
 #include "hpsc-msg.h"
+#include "latency.h"
 #include "link.h"
 
 typedef enum {
     CMD_STATUS_SUCCESS,
     CMD_STATUS_HANDLER_FAILED,
     CMD_STATUS_REPLY_FAILED,
+    CMD_STATUS_EXPIRED,
     CMD_STATUS_UNKNOWN
 } cmd_status;
 
+// Command priority classes, highest first. Each class is queued separately, and
+// a higher class is always handled before a lower one.
+enum cmd_prio {
+    CMD_PRIO_DEFAULT, // from the link if it has one, else from the message type
+    CMD_PRIO_HIGH,
+    CMD_PRIO_NORMAL,
+    CMD_PRIO_LOW
+};
+#define CMD_PRIO_CLASSES 3
+
+// Points in a command's lifecycle, stamped in rtems_counter ticks (0 if not
+// reached). Commands enqueued other than by a link have no receive time.
+enum cmd_ts {
+    CMD_TS_RECV,
+    CMD_TS_ENQUEUE,
+    CMD_TS_DEQUEUE,
+    CMD_TS_HANDLE_START,
+    CMD_TS_HANDLE_END,
+    CMD_TS_REPLY_SEND,
+    CMD_TS_REPLY_ACK,
+    CMD_TS_COUNT
+};
+
 struct cmd {
     uint8_t msg[HPSC_MSG_SIZE];
     struct link *link;
+    // optional scheduling overrides, zero for the defaults
+    enum cmd_prio prio;
+    rtems_interval deadline_ticks; // relative to enqueue
+    rtems_counter_ticks ts[CMD_TS_COUNT];
 };
 
+// cmd_enqueue return value: enqueued, but the queue is filling up
+#define CMD_ENQUEUE_HIGH_WATERMARK 1
+
+// cmd_register flags
+#define CMD_FLAG_REPLY_EXPECTED 0x1 // failing to produce a reply is an error
+// handler may run in an interrupt context, see cmd_handle_isr
+#define CMD_FLAG_ISR_SAFE       0x2
+
 typedef ssize_t (cmd_handler_t)(struct cmd *cmd, void *reply, size_t reply_sz);
 typedef void (cmd_handled_t)(void *arg, cmd_status status);
 
+struct cmd_type_stats {
+    uint32_t count;
+    uint32_t failed;
+    uint32_t expired;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+// Latency histograms: stage[i] is the time from timestamp i to i + 1, and the
+// last stage is the total, from the first timestamp to the last.
+#define CMD_LATENCY_TOTAL (CMD_TS_COUNT - 1)
+struct cmd_latency {
+    struct latency_hist stage[CMD_TS_COUNT];
+};
+
+// A command server: queues, handler tasks, handlers and completion hooks.
+// Applications may create several, e.g., to isolate classes of links.
+struct cmd_server;
+
+/**
+ * Create a command server with n_workers handler tasks, each with a queue per
+ * priority class (see enum cmd_prio) with room for len commands (rounded up to
+ * a power of two). Enqueueing reports when a queue's depth reaches hwm (0 to
+ * disable).
+ * Commands are dispatched to workers by link, so commands from the same link
+ * and priority class are handled in order, but commands from different links
+ * may be handled in parallel by different workers.
+ * Returns NULL on failure.
+ */
+struct cmd_server *cmd_server_create(size_t n_workers, size_t len, size_t hwm);
+
+/**
+ * Destroy a command server, dropping any commands in its queues.
+ * The handler tasks must be stopped, and nothing may enqueue concurrently.
+ */
+rtems_status_code cmd_server_destroy(struct cmd_server *s);
+
+/**
+ * Set the server for commands received on links that don't have their own
+ * (see link_set_cmd_server), or NULL for none.
+ */
+void cmd_server_set_default(struct cmd_server *s);
+
+/**
+ * Get the default server, or NULL if none.
+ */
+struct cmd_server *cmd_server_get_default(void);
+
+/**
+ * Get the server for commands received on a link: the link's own, else the
+ * default server. May return NULL.
+ */
+struct cmd_server *cmd_server_for_link(struct link *link);
+
+/**
+ * Register the handler for a message type, which takes precedence over the
+ * default handler given to cmd_handle_tasks_start.
+ * Register at init, before starting the handler tasks.
+ */
+rtems_status_code cmd_register(struct cmd_server *s, enum hpsc_msg_type type,
+                               cmd_handler_t *handler, uint32_t flags);
+
+/**
+ * Unregister the handler for a message type.
+ * Don't use while the handler tasks are running.
+ */
+void cmd_unregister(struct cmd_server *s, enum hpsc_msg_type type);
+
+/**
+ * Set a message type's default priority class, and its relative deadline in
+ * ticks (0 for none). Commands still queued past their deadline are dropped.
+ * Notifications default to CMD_PRIO_HIGH, bulk transfers to CMD_PRIO_LOW, and
+ * all others to CMD_PRIO_NORMAL, without deadlines.
+ * Configure at init, before starting the handler tasks.
+ */
+void cmd_set_sched(struct cmd_server *s, enum hpsc_msg_type type,
+                   enum cmd_prio prio, rtems_interval deadline_ticks);
+
+/**
+ * Monitor a worker's health, or stop if g is NULL: while its handler task runs,
+ * it's registered in the group, and checks in between commands and at least
+ * every period_ticks / 2 while idle.
+ * Handlers that may run for longer than period_ticks must call cmd_check_in
+ * as they go, e.g., between parts of a large copy.
+ * Configure at init, before starting the handler tasks, which fails if the
+ * group is full.
+ */
+rtems_status_code cmd_set_health(struct cmd_server *s, size_t worker,
+                                 struct health_group *g,
+                                 rtems_interval period_ticks);
+
+/**
+ * Check in the worker running the calling handler (see cmd_set_health).
+ * A no-op outside of workers, including in fast path (interrupt) handlers.
+ */
+void cmd_check_in(void);
+
+/**
+ * Get the flags a message type's handler was registered with, or 0 if none.
+ */
+uint32_t cmd_get_flags(struct cmd_server *s, enum hpsc_msg_type type);
+
+/**
+ * Get the statistics of a message type: the number of invocations and failures
+ * of its registered handler and their total and maximum handling times, and the
+ * number of its commands that expired before being handled.
+ */
+void cmd_get_stats(struct cmd_server *s, enum hpsc_msg_type type,
+                   struct cmd_type_stats *stats);
+
+/**
+ * Get the latency histograms of a message type's commands that were handled.
+ * Each link also keeps a histogram of the total latency of its commands.
+ */
+void cmd_get_latency(struct cmd_server *s, enum hpsc_msg_type type,
+                     struct cmd_latency *lat);
+
+/**
+ * Get a short name for a latency stage, e.g., "queued" from enqueue to dequeue.
+ */
+const char *cmd_latency_stage_name(unsigned stage);
+
+/**
+ * Reset the statistics and latency histograms of all message types.
+ */
+void cmd_reset_stats(struct cmd_server *s);
+
 /**
- * Register a callback handler to be run after every queued command is handled.
- * This operation is not synchronized with cmd_handle_task, so don't use after
- * cmd_handle_task is started unless the command queue is empty and guaranteed 
+ * Register a callback handler to be run after every queued command is handled,
+ * which for commands with a reply is when the remote ACKs it, or fails to.
+ * With handlers registered with CMD_FLAG_ISR_SAFE, it must be interrupt-safe
+ * too (see cmd_handle_isr).
+ * With multiple workers, the callback may run concurrently in different tasks.
+ * This operation is not synchronized with the handler tasks, so don't use after
+ * they are started unless the command queues are empty and guaranteed
  * not to enqueue new commands until operation completes.
  */
-void cmd_handled_register_cb(cmd_handled_t *cb, void *cb_arg);
+void cmd_handled_register_cb(struct cmd_server *s, cmd_handled_t *cb,
+                             void *cb_arg);
 
 /**
  * Unregister the callback handler.
- * This operation is not synchronized with cmd_handle_task, so don't use after
- * cmd_handle_task is started unless the command queue is empty and guaranteed 
+ * This operation is not synchronized with the handler tasks, so don't use after
+ * they are started unless the command queues are empty and guaranteed
  * not to enqueue new commands until operation completes.
  */
-void cmd_handled_unregister_cb(void);
+void cmd_handled_unregister_cb(struct cmd_server *s);
 
 /**
  * Enqueue a command with its own callback handler (cmd struct will be copied).
- * The specified callback handler will be executed before the global handler.
+ * The command is queued in its priority class, and expires at its deadline.
+ * The specified callback handler will be executed before the server's handler.
+ * Lock-free, may be called from an interrupt context.
+ * Returns 0 on success, CMD_ENQUEUE_HIGH_WATERMARK on success if the queue
+ * depth reached its high watermark, or a negative value if there's no server,
+ * the queue is full, or the handler task couldn't be notified.
  */
-int cmd_enqueue_cb(struct cmd *cmd, cmd_handled_t *cb, void *cb_arg);
+int cmd_enqueue_cb(struct cmd_server *s, struct cmd *cmd, cmd_handled_t *cb,
+                   void *cb_arg);
 
 /**
  * Enqueue a command (cmd struct will be copied).
+ * Returns the same as cmd_enqueue_cb.
+ */
+int cmd_enqueue(struct cmd_server *s, struct cmd *cmd);
+
+/**
+ * Reserve a queue slot for a command received on link, so the link can read
+ * the message directly into it instead of copying it in with cmd_enqueue.
+ * Fill in the message, and optionally the scheduling overrides, then commit.
+ * The slot holds up the worker until committed, so commit promptly in the same
+ * context. Lock-free, may be called from an interrupt context.
+ * Returns NULL if there's no server or the queue is full.
+ */
+struct cmd *cmd_reserve(struct cmd_server *s, struct link *link);
+
+/**
+ * Commit a command reserved with cmd_reserve, to be handled in place.
+ * A command whose message type puts it in a different priority class than its
+ * link's is copied to that class's queue instead.
+ * Returns the same as cmd_enqueue_cb.
+ */
+int cmd_commit(struct cmd_server *s, struct cmd *cmd);
+
+/**
+ * Abandon a command reserved with cmd_reserve, e.g., one handled by
+ * cmd_handle_isr instead. Lock-free, may be called from an interrupt context.
+ */
+void cmd_cancel(struct cmd_server *s, struct cmd *cmd);
+
+/**
+ * Handle a command received on a link right away, in the caller's context,
+ * if its message type's handler was registered with CMD_FLAG_ISR_SAFE and the
+ * link has no message in flight. A reply is written to the link directly, and
+ * its ACK isn't tracked. The server's handled callback is run with the status
+ * (but not until the ACK, and possibly in an interrupt context).
+ * Returns false if the command must be queued instead.
  */
-int cmd_enqueue(struct cmd *cmd);
+bool cmd_handle_isr(struct cmd_server *s, struct cmd *cmd);
 
 /**
- * Drop all commands in the queue without handling them.
+ * Drop all commands in the queues without handling them.
+ * The handler tasks must be stopped.
  */
-size_t cmd_drop_all(void);
+size_t cmd_drop_all(struct cmd_server *s);
 
 /**
- * Start the cmd_handle_task (task must be created by the caller).
+ * Start the handler tasks, one per worker (tasks must be created by the caller,
+ * who may also set their affinity, e.g., pin each one to a different CPU).
+ * The default handler cb handles message types without a registered handler,
+ * and may be NULL.
+ * Replies are sent without blocking the worker, which keeps handling commands
+ * while it waits up to timeout_ticks (RTEMS_NO_TIMEOUT for forever) for each
+ * reply's ACK. A link's replies are sent in order, one at a time.
+ * On failure, the tasks that were started are stopped, but none are deleted.
  */
-rtems_status_code cmd_handle_task_start(rtems_id task_id, cmd_handler_t cb,
-                                        rtems_interval timeout_ticks);
+rtems_status_code cmd_handle_tasks_start(struct cmd_server *s,
+                                         const rtems_id *task_ids,
+                                         cmd_handler_t cb,
+                                         rtems_interval timeout_ticks);
 
 /**
- * Stop the cmd_handle_task.
+ * Stop the handler tasks.
  */
-rtems_status_code cmd_handle_task_destroy(void);
+rtems_status_code cmd_handle_tasks_destroy(struct cmd_server *s);
 
 #endif // COMMAND_H
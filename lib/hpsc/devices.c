@@ -19,43 +19,64 @@ struct hpsc_mbox *dev_get_mbox(dev_id_mbox id)
     return devs_mbox[id];
 }
 
-static Per_CPU_Control *cpu_get_control(void)
+static Per_CPU_Control *cpu_get_control(uint32_t cpu)
 {
-    return _Per_CPU_Get_by_index(rtems_get_current_processor());
+    assert(cpu < rtems_get_processor_count());
+    return _Per_CPU_Get_by_index(cpu);
 }
 
 static PER_CPU_DATA_ITEM(struct hpsc_rti_timer *, rtits) = { 0 };
-void dev_cpu_set_rtit(struct hpsc_rti_timer *dev)
+void dev_cpu_set_rtit_for(uint32_t cpu, struct hpsc_rti_timer *dev)
 {
     struct hpsc_rti_timer **tmp;
-    tmp = PER_CPU_DATA_GET(cpu_get_control(), struct hpsc_rti_timer *, rtits);
+    tmp = PER_CPU_DATA_GET(cpu_get_control(cpu), struct hpsc_rti_timer *,
+                           rtits);
     assert(tmp);
     if (dev)
         assert(!*tmp); // not already set
     *tmp = dev;
 }
-struct hpsc_rti_timer *dev_cpu_get_rtit(void)
+struct hpsc_rti_timer *dev_cpu_get_rtit_for(uint32_t cpu)
 {
     struct hpsc_rti_timer **tmp;
-    tmp = PER_CPU_DATA_GET(cpu_get_control(), struct hpsc_rti_timer *, rtits);
+    tmp = PER_CPU_DATA_GET(cpu_get_control(cpu), struct hpsc_rti_timer *,
+                           rtits);
     assert(tmp);
     return *tmp;
 }
+void dev_cpu_set_rtit(struct hpsc_rti_timer *dev)
+{
+    dev_cpu_set_rtit_for(rtems_get_current_processor(), dev);
+}
+struct hpsc_rti_timer *dev_cpu_get_rtit(void)
+{
+    return dev_cpu_get_rtit_for(rtems_get_current_processor());
+}
 
 static PER_CPU_DATA_ITEM(struct HPSC_WDT_Config *, wdts) = { 0 };
-void dev_cpu_set_wdt(struct HPSC_WDT_Config *dev)
+void dev_cpu_set_wdt_for(uint32_t cpu, struct HPSC_WDT_Config *dev)
 {
     struct HPSC_WDT_Config **tmp;
-    tmp = PER_CPU_DATA_GET(cpu_get_control(), struct HPSC_WDT_Config *, wdts);
+    tmp = PER_CPU_DATA_GET(cpu_get_control(cpu), struct HPSC_WDT_Config *,
+                           wdts);
     assert(tmp);
     if (dev)
         assert(!*tmp); // not already set
     *tmp = dev;
 }
-struct HPSC_WDT_Config *dev_cpu_get_wdt(void)
+struct HPSC_WDT_Config *dev_cpu_get_wdt_for(uint32_t cpu)
 {
     struct HPSC_WDT_Config **tmp;
-    tmp = PER_CPU_DATA_GET(cpu_get_control(), struct HPSC_WDT_Config *, wdts);
+    tmp = PER_CPU_DATA_GET(cpu_get_control(cpu), struct HPSC_WDT_Config *,
+                           wdts);
     assert(tmp);
     return *tmp;
 }
+void dev_cpu_set_wdt(struct HPSC_WDT_Config *dev)
+{
+    dev_cpu_set_wdt_for(rtems_get_current_processor(), dev);
+}
+struct HPSC_WDT_Config *dev_cpu_get_wdt(void)
+{
+    return dev_cpu_get_wdt_for(rtems_get_current_processor());
+}
@@ -40,6 +40,16 @@ struct hpsc_mbox *dev_get_mbox(dev_id_mbox id);
          cpu < rtems_get_processor_count(); \
          cpu++)
 
+// The _for variants access any CPU's handles without running on that CPU.
+
+/**
+ * Set (or unset) the pointer to a CPU's RTI Timer device handle.
+ */
+void dev_cpu_set_rtit_for(uint32_t cpu, struct hpsc_rti_timer *dev);
+/**
+ * Get the pointer to a CPU's RTI Timer device handle, or NULL.
+ */
+struct hpsc_rti_timer *dev_cpu_get_rtit_for(uint32_t cpu);
 /**
  * Set (or unset) the pointer to the current CPU's RTI Timer device handle.
  */
@@ -49,6 +59,14 @@ void dev_cpu_set_rtit(struct hpsc_rti_timer *dev);
  */
 struct hpsc_rti_timer *dev_cpu_get_rtit(void);
 
+/**
+ * Set (or unset) the pointer to a CPU's Watchdog device handle.
+ */
+void dev_cpu_set_wdt_for(uint32_t cpu, struct HPSC_WDT_Config *dev);
+/**
+ * Get the pointer to a CPU's Watchdog device handle, or NULL.
+ */
+struct HPSC_WDT_Config *dev_cpu_get_wdt_for(uint32_t cpu);
 /**
  * Set (or unset) the pointer to the current CPU's Watchdog device handle.
  */
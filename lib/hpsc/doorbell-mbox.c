@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/bspIo.h>
+
+// drivers
+#include <hpsc-mbox.h>
+
+#include "doorbell.h"
+#include "doorbell-mbox.h"
+
+struct doorbell_mbox {
+    struct hpsc_mbox *mbox;
+    unsigned chan_from;
+    unsigned chan_to;
+};
+
+
+static void doorbell_mbox_rcv(void *arg)
+{
+    struct doorbell *db = arg;
+    struct doorbell_mbox *mdb = db->priv;
+    // clear before notifying, so a ring during the callback isn't lost
+    hpsc_mbox_chan_event_clear_rcv(mdb->mbox, mdb->chan_from);
+    doorbell_rung(db);
+}
+
+static void doorbell_mbox_ring(struct doorbell *db)
+{
+    struct doorbell_mbox *mdb = db->priv;
+    hpsc_mbox_chan_event_set_rcv(mdb->mbox, mdb->chan_to);
+}
+
+static int doorbell_mbox_close(struct doorbell *db)
+{
+    struct doorbell_mbox *mdb = db->priv;
+    rtems_status_code sc;
+    int rc = 0;
+    printk("%s: close\n", db->name);
+    // in case of failure, keep going and fwd code
+    sc = hpsc_mbox_chan_release(mdb->mbox, mdb->chan_from);
+    if (sc != RTEMS_SUCCESSFUL)
+        rc = 1;
+    sc = hpsc_mbox_chan_release(mdb->mbox, mdb->chan_to);
+    if (sc != RTEMS_SUCCESSFUL)
+        rc = 1;
+    free(mdb);
+    free(db);
+    return rc;
+}
+
+struct doorbell *doorbell_mbox_open(const char *name, struct hpsc_mbox *mbox,
+                                    unsigned idx_from, unsigned idx_to,
+                                    uint8_t server, uint8_t client)
+{
+    struct doorbell_mbox *mdb;
+    struct doorbell *db;
+    rtems_status_code sc;
+    assert(name);
+
+    printk("%s: open\n", name);
+    printk("\tidx_from = %u\n", idx_from);
+    printk("\tidx_to   = %u\n", idx_to);
+    printk("\tserver   = 0x%x\n", server);
+    printk("\tclient   = 0x%x\n", client);
+    db = malloc(sizeof(*db));
+    if (!db)
+        return NULL;
+    mdb = malloc(sizeof(*mdb));
+    if (!mdb)
+        goto free_db;
+
+    doorbell_init(db, name, mdb);
+    db->ring = doorbell_mbox_ring;
+    db->close = doorbell_mbox_close;
+
+    mdb->mbox = mbox;
+    mdb->chan_from = idx_from;
+    mdb->chan_to = idx_to;
+
+    sc = hpsc_mbox_chan_claim(mbox, idx_from, server, client, server,
+                              doorbell_mbox_rcv, NULL, db);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printk("ERROR: doorbell_mbox_open: failed to claim chan_from\n");
+        goto free_dbs;
+    }
+    // nobody waits for the remote to ACK a ring
+    sc = hpsc_mbox_chan_claim(mbox, idx_to, server, server, client,
+                              NULL, NULL, db);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printk("ERROR: doorbell_mbox_open: failed to claim chan_to\n");
+        goto free_from;
+    }
+
+    return db;
+
+free_from:
+    hpsc_mbox_chan_release(mbox, idx_from);
+free_dbs:
+    free(mdb);
+free_db:
+    free(db);
+    return NULL;
+}
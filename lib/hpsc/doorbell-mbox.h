@@ -0,0 +1,19 @@
+#ifndef DOORBELL_MBOX_H
+#define DOORBELL_MBOX_H
+
+#include <stdint.h>
+
+// drivers
+#include <hpsc-mbox.h>
+
+#include "doorbell.h"
+
+// Claims mailbox channels like link_mbox_connect, but no data is exchanged.
+// To claim as server: set both server and client to non-zero ID
+//                     the server value is also used as the owner
+// To claim as client: set server to 0 and set client to non-zero ID
+struct doorbell *doorbell_mbox_open(const char *name, struct hpsc_mbox *mbox,
+                                    unsigned idx_from, unsigned idx_to,
+                                    uint8_t server, uint8_t client);
+
+#endif // DOORBELL_MBOX_H
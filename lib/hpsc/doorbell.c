@@ -0,0 +1,53 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/irq-extension.h>
+
+#include "doorbell.h"
+
+void doorbell_subscribe(struct doorbell *db, rtems_interrupt_handler cb,
+                        void *cb_arg)
+{
+    assert(db);
+    assert(cb);
+    // clear the handler first so a ring can't see a mismatched cb/cb_arg pair
+    db->cb = NULL;
+    db->cb_arg = cb_arg;
+    db->cb = cb;
+}
+
+void doorbell_unsubscribe(struct doorbell *db)
+{
+    assert(db);
+    db->cb = NULL;
+    db->cb_arg = NULL;
+}
+
+void doorbell_ring(struct doorbell *db)
+{
+    assert(db);
+    db->ring(db);
+}
+
+int doorbell_close(struct doorbell *db)
+{
+    assert(db);
+    return db->close(db);
+}
+
+void doorbell_init(struct doorbell *db, const char *name, void *priv)
+{
+    db->name = name;
+    db->priv = priv;
+    db->cb = NULL;
+    db->cb_arg = NULL;
+}
+
+void doorbell_rung(void *arg)
+{
+    struct doorbell *db = arg;
+    rtems_interrupt_handler cb = db->cb;
+    if (cb)
+        cb(db->cb_arg);
+}
@@ -0,0 +1,48 @@
+#ifndef DOORBELL_H
+#define DOORBELL_H
+
+#include <rtems.h>
+#include <rtems/irq-extension.h>
+
+/**
+ * A doorbell notifies a remote that shared state (e.g., a shared memory region)
+ * has changed, without carrying any data itself.
+ * Doorbell implementations populate this struct.
+ * Doorbell users use the functions described below, NOT the function pointers.
+ */
+struct doorbell {
+    const char *name;
+    void *priv;
+    // may be modified while the doorbell is open, run in an interrupt context
+    volatile rtems_interrupt_handler cb;
+    void *volatile cb_arg;
+    void (*ring)(struct doorbell *db);
+    int (*close)(struct doorbell *db);
+};
+
+/*
+ * These functions are for doorbell users
+ */
+/**
+ * Set the callback to run (in an interrupt context) when the remote rings.
+ * Rings received without a subscriber are dropped.
+ */
+void doorbell_subscribe(struct doorbell *db, rtems_interrupt_handler cb,
+                        void *cb_arg);
+void doorbell_unsubscribe(struct doorbell *db);
+/**
+ * Ring the remote's doorbell. May be called from an interrupt context.
+ * Rings may be coalesced, so the remote must check all state it is interested
+ * in each time its callback runs.
+ */
+void doorbell_ring(struct doorbell *db);
+int doorbell_close(struct doorbell *db);
+
+/*
+ * These functions are for doorbell implementations
+ */
+void doorbell_init(struct doorbell *db, const char *name, void *priv);
+// compatible with rtems_interrupt_handler, expects a doorbell arg
+void doorbell_rung(void *arg);
+
+#endif // DOORBELL_H
@@ -0,0 +1,470 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+
+#include "file-xfer.h"
+#include "hpsc-msg.h"
+#include "link.h"
+#include "mem-access.h"
+#include "task-join.h"
+
+#define FILE_XFER_EVENT_READ_AHEAD RTEMS_EVENT_0
+#define FILE_XFER_EVENT_EXIT RTEMS_EVENT_1
+
+#define FILE_XFER_WINDOW_SIZE (FILE_XFER_CHUNKS * FILE_XFER_CHUNK_SIZE)
+
+struct file_xfer_root {
+    char path[HPSC_MSG_FILE_PATH_SIZE];
+    unsigned perms; // 0 if unused
+};
+
+struct file_xfer_chunk {
+    bool valid;
+    uint32_t offset; // aligned to FILE_XFER_CHUNK_SIZE
+    uint32_t len; // short at the end of the file
+    uint8_t data[FILE_XFER_CHUNK_SIZE];
+};
+
+struct file_xfer_handle {
+    bool open;
+    struct link *link;
+    unsigned perms; // FILE_XFER_READ or FILE_XFER_WRITE
+    int fd;
+    uint32_t size; // when opened, bounds read-ahead
+    uint32_t pos; // chunk offset of the last read, where the window starts
+    rtems_interval used; // ticks when last used
+    struct file_xfer_chunk chunks[FILE_XFER_CHUNKS];
+};
+
+static struct file_xfer_root roots[FILE_XFER_ROOTS_MAX];
+static struct file_xfer_handle handles[FILE_XFER_HANDLES_MAX];
+static rtems_mutex mtx = RTEMS_MUTEX_INITIALIZER("File Xfer");
+static rtems_id ra_tid;
+static struct task_join ra_join;
+
+static enum hpsc_msg_file_status file_xfer_status(int err)
+{
+    switch (err) {
+    case ENOENT:
+        return FILE_STATUS_NOT_FOUND;
+    case EACCES:
+    case EPERM:
+        return FILE_STATUS_DENIED;
+    default:
+        return FILE_STATUS_FAILED;
+    }
+}
+
+// caller must hold mtx
+static bool file_xfer_allowed(const char *path, unsigned perms)
+{
+    const char *p;
+    size_t n;
+    size_t i;
+    if (path[0] != '/')
+        return false;
+    for (p = path; (p = strstr(p, "..")); p += 2)
+        if ((p == path || p[-1] == '/') && (p[2] == '/' || p[2] == '\0'))
+            return false;
+    for (i = 0; i < FILE_XFER_ROOTS_MAX; i++) {
+        if (!roots[i].perms || (roots[i].perms & perms) != perms)
+            continue;
+        n = strlen(roots[i].path);
+        if (strncmp(path, roots[i].path, n))
+            continue;
+        // at a component boundary, e.g., "/a" allows "/a/b" but not "/ab"
+        if (roots[i].path[n - 1] == '/' || path[n] == '/' || path[n] == '\0')
+            return true;
+    }
+    return false;
+}
+
+// caller must hold mtx
+static struct file_xfer_handle *file_xfer_handle_alloc(rtems_interval now)
+{
+    rtems_interval idle =
+        FILE_XFER_IDLE_SECONDS * rtems_clock_get_ticks_per_second();
+    struct file_xfer_handle *lru = NULL;
+    size_t i;
+    for (i = 0; i < FILE_XFER_HANDLES_MAX; i++) {
+        if (!handles[i].open)
+            return &handles[i];
+        if (!lru || now - handles[i].used > now - lru->used)
+            lru = &handles[i];
+    }
+    if (now - lru->used < idle)
+        return NULL;
+    printf("file-xfer: reclaiming idle handle %zu\n", (size_t)(lru - handles));
+    close(lru->fd);
+    lru->open = false;
+    return lru;
+}
+
+// caller must hold mtx
+static struct file_xfer_handle *file_xfer_handle_get(struct link *link,
+                                                     uint8_t handle,
+                                                     unsigned perms)
+{
+    struct file_xfer_handle *h;
+    if (handle >= FILE_XFER_HANDLES_MAX)
+        return NULL;
+    h = &handles[handle];
+    if (!h->open || h->link != link || h->perms != perms)
+        return NULL;
+    h->used = rtems_clock_get_ticks_since_boot();
+    return h;
+}
+
+// caller must hold mtx
+static enum hpsc_msg_file_status
+file_xfer_open(struct link *link, const char *path, unsigned perms, int flags,
+               uint8_t *handle, uint32_t *size)
+{
+    rtems_interval now = rtems_clock_get_ticks_since_boot();
+    struct file_xfer_handle *h;
+    struct stat st;
+    size_t i;
+    int err;
+    if (!memchr(path, '\0', HPSC_MSG_FILE_PATH_SIZE))
+        return FILE_STATUS_INVALID;
+    if (!file_xfer_allowed(path, perms))
+        return FILE_STATUS_DENIED;
+    h = file_xfer_handle_alloc(now);
+    if (!h)
+        return FILE_STATUS_BUSY;
+    h->fd = open(path, flags, 0644);
+    if (h->fd < 0)
+        return file_xfer_status(errno);
+    if (fstat(h->fd, &st)) {
+        err = errno;
+        close(h->fd);
+        return file_xfer_status(err);
+    }
+    h->open = true;
+    h->link = link;
+    h->perms = perms;
+    h->size = st.st_size > UINT32_MAX ? UINT32_MAX : st.st_size;
+    h->pos = 0;
+    h->used = now;
+    for (i = 0; i < FILE_XFER_CHUNKS; i++)
+        h->chunks[i].valid = false;
+    *handle = h - handles;
+    *size = h->size;
+    return FILE_STATUS_OK;
+}
+
+// caller must hold mtx
+static enum hpsc_msg_file_status file_xfer_close(struct link *link,
+                                                 uint8_t handle,
+                                                 unsigned perms)
+{
+    struct file_xfer_handle *h = file_xfer_handle_get(link, handle, perms);
+    if (!h)
+        return FILE_STATUS_INVALID;
+    h->open = false;
+    return close(h->fd) ? file_xfer_status(errno) : FILE_STATUS_OK;
+}
+
+// caller must hold mtx
+static struct file_xfer_chunk *file_xfer_chunk_find(struct file_xfer_handle *h,
+                                                    uint32_t offset)
+{
+    size_t i;
+    for (i = 0; i < FILE_XFER_CHUNKS; i++)
+        if (h->chunks[i].valid && h->chunks[i].offset == offset)
+            return &h->chunks[i];
+    return NULL;
+}
+
+// Read a chunk into a buffer that's empty or outside the window.
+// caller must hold mtx
+static struct file_xfer_chunk *file_xfer_chunk_read(struct file_xfer_handle *h,
+                                                    uint32_t offset)
+{
+    struct file_xfer_chunk *c = NULL;
+    ssize_t rc;
+    size_t i;
+    for (i = 0; i < FILE_XFER_CHUNKS && !c; i++) {
+        if (!h->chunks[i].valid || h->chunks[i].offset < h->pos ||
+            h->chunks[i].offset - h->pos >= FILE_XFER_WINDOW_SIZE)
+            c = &h->chunks[i];
+    }
+    // the window has a position for each buffer, and offset's isn't cached
+    assert(c);
+    c->valid = false;
+    rc = pread(h->fd, c->data, sizeof(c->data), offset);
+    if (rc < 0)
+        return NULL;
+    c->valid = true;
+    c->offset = offset;
+    c->len = rc;
+    return c;
+}
+
+// Read one chunk ahead of a reader's window, returning false if none did.
+static bool file_xfer_read_ahead(void)
+{
+    struct file_xfer_handle *h;
+    uint32_t offset;
+    bool rc = false;
+    size_t i;
+    size_t k;
+    rtems_mutex_lock(&mtx);
+    for (i = 0; i < FILE_XFER_HANDLES_MAX && !rc; i++) {
+        h = &handles[i];
+        if (!h->open || h->perms != FILE_XFER_READ)
+            continue;
+        for (k = 1; k < FILE_XFER_CHUNKS; k++) {
+            offset = h->pos + k * FILE_XFER_CHUNK_SIZE;
+            if (offset >= h->size || offset < h->pos)
+                break;
+            if (!file_xfer_chunk_find(h, offset)) {
+                // failed reads are retried on demand
+                rc = file_xfer_chunk_read(h, offset) != NULL;
+                break;
+            }
+        }
+    }
+    rtems_mutex_unlock(&mtx);
+    return rc;
+}
+
+// Reads stop short at the end of a chunk, or at the end of the file.
+// caller must hold mtx
+static enum hpsc_msg_file_status
+file_xfer_read(struct file_xfer_handle *h, const struct hpsc_msg_file_xfer *x,
+               struct hpsc_msg_read_value_payload *rep)
+{
+    uint32_t offset = x->offset;
+    uint32_t skip = offset % FILE_XFER_CHUNK_SIZE;
+    uint32_t len = x->len;
+    uint32_t buf = x->buf;
+    struct file_xfer_chunk *c;
+    if (len > FILE_XFER_CHUNK_SIZE - skip)
+        len = FILE_XFER_CHUNK_SIZE - skip;
+    if (!buf && len > sizeof(rep->data))
+        len = sizeof(rep->data);
+    if (buf && !mem_access_check(buf, len, MEM_ACCESS_WRITE))
+        return FILE_STATUS_DENIED;
+    h->pos = offset - skip;
+    c = file_xfer_chunk_find(h, h->pos);
+    if (!c) {
+        c = file_xfer_chunk_read(h, h->pos);
+        if (!c)
+            return file_xfer_status(errno);
+    }
+    if (skip >= c->len)
+        len = 0;
+    else if (len > c->len - skip)
+        len = c->len - skip;
+    memcpy(buf ? (void *)(uintptr_t) buf : rep->data, &c->data[skip], len);
+    rep->len = len;
+    return FILE_STATUS_OK;
+}
+
+// caller must hold mtx
+static enum hpsc_msg_file_status
+file_xfer_write(struct file_xfer_handle *h,
+                const struct hpsc_msg_write_file_payload *req,
+                struct hpsc_msg_write_status_payload *rep)
+{
+    const void *src = req->data;
+    uint32_t len = req->xfer.len;
+    uint32_t buf = req->xfer.buf;
+    ssize_t rc;
+    if (buf) {
+        if (!mem_access_check(buf, len, MEM_ACCESS_READ))
+            return FILE_STATUS_DENIED;
+        src = (const void *)(uintptr_t) buf;
+    } else if (len > sizeof(req->data)) {
+        return FILE_STATUS_INVALID;
+    }
+    rc = pwrite(h->fd, src, len, req->xfer.offset);
+    if (rc < 0)
+        return file_xfer_status(errno);
+    rep->len = rc;
+    return FILE_STATUS_OK;
+}
+
+rtems_status_code file_xfer_allow(const char *root, unsigned perms)
+{
+    rtems_status_code sc = RTEMS_TOO_MANY;
+    size_t n;
+    size_t i;
+    assert(root);
+    n = strlen(root);
+    if (root[0] != '/' || n >= HPSC_MSG_FILE_PATH_SIZE)
+        return RTEMS_INVALID_NAME;
+    if (!perms || (perms & ~(FILE_XFER_READ | FILE_XFER_WRITE)))
+        return RTEMS_INVALID_NUMBER;
+    rtems_mutex_lock(&mtx);
+    for (i = 0; i < FILE_XFER_ROOTS_MAX; i++) {
+        if (!roots[i].perms) {
+            strcpy(roots[i].path, root);
+            // "/a/" is the same as "/a", but "/" stays
+            if (n > 1 && roots[i].path[n - 1] == '/')
+                roots[i].path[n - 1] = '\0';
+            roots[i].perms = perms;
+            sc = RTEMS_SUCCESSFUL;
+            break;
+        }
+    }
+    rtems_mutex_unlock(&mtx);
+    return sc;
+}
+
+rtems_status_code file_xfer_revoke(const char *root)
+{
+    rtems_status_code sc = RTEMS_INVALID_NAME;
+    size_t i;
+    assert(root);
+    rtems_mutex_lock(&mtx);
+    for (i = 0; i < FILE_XFER_ROOTS_MAX; i++) {
+        if (roots[i].perms && !strcmp(roots[i].path, root)) {
+            roots[i].perms = 0;
+            sc = RTEMS_SUCCESSFUL;
+            break;
+        }
+    }
+    rtems_mutex_unlock(&mtx);
+    return sc;
+}
+
+static rtems_task file_xfer_task(rtems_task_argument arg)
+{
+    rtems_event_set events;
+    while (1) {
+        events = 0;
+        rtems_event_receive(FILE_XFER_EVENT_READ_AHEAD | FILE_XFER_EVENT_EXIT,
+                            RTEMS_EVENT_ANY, RTEMS_NO_TIMEOUT, &events);
+        if (events & FILE_XFER_EVENT_EXIT)
+            break; // we've been ordered to exit
+        // a chunk at a time, so handlers wait for at most one read
+        while (file_xfer_read_ahead())
+            ;
+    }
+    task_join_exit(&ra_join);
+}
+
+rtems_status_code file_xfer_task_start(rtems_id task_id)
+{
+    assert(!task_join_is_running(&ra_join));
+    ra_tid = task_id;
+    return task_join_start(&ra_join, task_id, file_xfer_task, 0);
+}
+
+rtems_status_code file_xfer_task_destroy(void)
+{
+    rtems_status_code sc;
+    assert(task_join_is_running(&ra_join));
+    assert(ra_tid != rtems_task_self());
+    sc = rtems_event_send(ra_tid, FILE_XFER_EVENT_EXIT);
+    if (sc == RTEMS_SUCCESSFUL)
+        task_join_wait(&ra_join);
+    return sc;
+}
+
+ssize_t file_xfer_read_file(struct link *link, const void *msg, void *reply,
+                            size_t reply_sz)
+{
+    const struct hpsc_msg_read_file_payload *req =
+        hpsc_msg_read_file_decode(msg);
+    struct hpsc_msg_read_value_payload *rep;
+    struct hpsc_msg_file_xfer x;
+    struct file_xfer_handle *h;
+    uint8_t handle = 0;
+    uint32_t size = 0;
+    if (!req || reply_sz != HPSC_MSG_SIZE)
+        return -1;
+    rep = hpsc_msg_read_value_encode(reply);
+    rep->id = READ_FILE;
+    rep->handle = req->handle;
+    rep->offset = 0;
+    rep->len = 0;
+    rtems_mutex_lock(&mtx);
+    switch (req->op) {
+    case FILE_OP_OPEN:
+        rep->status = file_xfer_open(link, req->path, FILE_XFER_READ, O_RDONLY,
+                                     &handle, &size);
+        rep->handle = handle;
+        rep->len = size;
+        break;
+    case FILE_OP_XFER:
+        x = req->xfer;
+        rep->offset = x.offset;
+        h = file_xfer_handle_get(link, req->handle, FILE_XFER_READ);
+        rep->status = h ? file_xfer_read(h, &x, rep) : FILE_STATUS_INVALID;
+        break;
+    case FILE_OP_CLOSE:
+        rep->status = file_xfer_close(link, req->handle, FILE_XFER_READ);
+        break;
+    default:
+        rep->status = FILE_STATUS_INVALID;
+        break;
+    }
+    rtems_mutex_unlock(&mtx);
+    if (rep->status != FILE_STATUS_OK)
+        printf("file-xfer: READ_FILE: op %u: status %u\n", req->op,
+               rep->status);
+    else if (req->op == FILE_OP_XFER && task_join_is_running(&ra_join))
+        rtems_event_send(ra_tid, FILE_XFER_EVENT_READ_AHEAD);
+    return reply_sz;
+}
+
+ssize_t file_xfer_write_file(struct link *link, const void *msg, void *reply,
+                             size_t reply_sz)
+{
+    const struct hpsc_msg_write_file_payload *req =
+        hpsc_msg_write_file_decode(msg);
+    struct hpsc_msg_write_status_payload *rep;
+    struct file_xfer_handle *h;
+    uint8_t handle = 0;
+    uint32_t size = 0;
+    int flags = O_WRONLY;
+    if (!req || reply_sz != HPSC_MSG_SIZE)
+        return -1;
+    rep = hpsc_msg_write_status_encode(reply);
+    rep->id = WRITE_FILE;
+    rep->handle = req->handle;
+    rep->offset = 0;
+    rep->len = 0;
+    rtems_mutex_lock(&mtx);
+    switch (req->op) {
+    case FILE_OP_OPEN:
+        if (req->flags & HPSC_MSG_FILE_CREATE)
+            flags |= O_CREAT;
+        if (req->flags & HPSC_MSG_FILE_TRUNC)
+            flags |= O_TRUNC;
+        rep->status = file_xfer_open(link, req->path, FILE_XFER_WRITE, flags,
+                                     &handle, &size);
+        rep->handle = handle;
+        rep->len = size;
+        break;
+    case FILE_OP_XFER:
+        rep->offset = req->xfer.offset;
+        h = file_xfer_handle_get(link, req->handle, FILE_XFER_WRITE);
+        rep->status = h ? file_xfer_write(h, req, rep) : FILE_STATUS_INVALID;
+        break;
+    case FILE_OP_CLOSE:
+        rep->status = file_xfer_close(link, req->handle, FILE_XFER_WRITE);
+        break;
+    default:
+        rep->status = FILE_STATUS_INVALID;
+        break;
+    }
+    rtems_mutex_unlock(&mtx);
+    if (rep->status != FILE_STATUS_OK)
+        printf("file-xfer: WRITE_FILE: op %u: status %u\n", req->op,
+               rep->status);
+    return reply_sz;
+}
@@ -0,0 +1,77 @@
+#ifndef FILE_XFER_H
+#define FILE_XFER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <rtems.h>
+
+#include "link.h"
+
+// File transfer service: serves READ_FILE and WRITE_FILE requests (see
+// hpsc-msg.h) from the RTEMS filesystem, over any link.
+// A remote opens a file by path, then transfers chunks at explicit offsets, so
+// it may keep a window of chunk requests outstanding instead of waiting for
+// each reply, and may resume an interrupted transfer at any offset.
+// Chunk data is inline in the messages, or in a buffer named by the remote,
+// which mem-access must allow (see mem_access_check).
+// Files being read are read ahead into a pool of chunk buffers per handle, by a
+// task started with file_xfer_task_start, so reads in a window are usually
+// served without waiting on the filesystem. Without the task, each chunk is
+// read on demand.
+// Handles are bound to the link that opened them. When all are in use, a
+// handle that has been idle for FILE_XFER_IDLE_SECONDS is reclaimed.
+// Writes are not seen by chunks already read ahead for other handles.
+// A request does at most one chunk of file I/O, so its handler stays well
+// within a command worker's health period (see cmd_set_health).
+// Functions may _not_ be called from an interrupt context.
+
+#define FILE_XFER_ROOTS_MAX 4
+#define FILE_XFER_HANDLES_MAX 4
+#define FILE_XFER_CHUNK_SIZE 512
+#define FILE_XFER_CHUNKS 4 // read-ahead pool per handle
+#define FILE_XFER_IDLE_SECONDS 60
+
+#define FILE_XFER_READ  0x1
+#define FILE_XFER_WRITE 0x2
+
+/**
+ * Allow access to the files under an absolute path, with FILE_XFER_READ and/or
+ * FILE_XFER_WRITE permissions. Paths with ".." components are always denied.
+ */
+rtems_status_code file_xfer_allow(const char *root, unsigned perms);
+
+/**
+ * Revoke access to a root, which must match a previously allowed one.
+ * Handles that are already open are not closed.
+ */
+rtems_status_code file_xfer_revoke(const char *root);
+
+/**
+ * Start the read-ahead task (the task must be created by the caller).
+ */
+rtems_status_code file_xfer_task_start(rtems_id task_id);
+
+/**
+ * Stop the read-ahead task. Must not be called by the task itself.
+ */
+rtems_status_code file_xfer_task_destroy(void);
+
+/**
+ * Serve a READ_FILE message received on link, writing a READ_VALUE reply.
+ * An invalid or denied request still gets a reply, with an error status.
+ * Returns the reply size, or -1 if the message isn't a READ_FILE.
+ */
+ssize_t file_xfer_read_file(struct link *link, const void *msg, void *reply,
+                            size_t reply_sz);
+
+/**
+ * Serve a WRITE_FILE message received on link, writing a WRITE_STATUS reply.
+ * An invalid or denied request still gets a reply, with an error status.
+ * Returns the reply size, or -1 if the message isn't a WRITE_FILE.
+ */
+ssize_t file_xfer_write_file(struct link *link, const void *msg, void *reply,
+                             size_t reply_sz);
+
+#endif // FILE_XFER_H
@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+
+#include "health.h"
+
+// serializes registration, across all groups
+static rtems_mutex mtx = RTEMS_MUTEX_INITIALIZER("Health");
+
+struct health_task *health_register(struct health_group *g, const char *name,
+                                    rtems_interval period_ticks)
+{
+    struct health_task *t = NULL;
+    size_t i;
+    assert(g);
+    assert(period_ticks);
+    rtems_mutex_lock(&mtx);
+    for (i = 0; i < HEALTH_TASKS_MAX; i++) {
+        if (!atomic_load_explicit(&g->tasks[i].active,
+                                  memory_order_relaxed)) {
+            t = &g->tasks[i];
+            break;
+        }
+    }
+    if (t) {
+        t->name = name;
+        t->period = period_ticks;
+        t->min_slack = period_ticks;
+        t->misses = 0;
+        health_check_in(t);
+        // publish to health_check
+        atomic_store_explicit(&t->active, true, memory_order_release);
+    }
+    rtems_mutex_unlock(&mtx);
+    return t;
+}
+
+void health_unregister(struct health_task *t)
+{
+    assert(t);
+    rtems_mutex_lock(&mtx);
+    atomic_store_explicit(&t->active, false, memory_order_release);
+    rtems_mutex_unlock(&mtx);
+}
+
+bool health_check(struct health_group *g)
+{
+    rtems_interval now = rtems_clock_get_ticks_since_boot();
+    struct health_task *t;
+    bool healthy = true;
+    int32_t slack;
+    size_t i;
+    assert(g);
+    for (i = 0; i < HEALTH_TASKS_MAX; i++) {
+        t = &g->tasks[i];
+        if (!atomic_load_explicit(&t->active, memory_order_acquire))
+            continue;
+        slack = (int32_t) t->period -
+            (int32_t)(now - atomic_load_explicit(&t->last,
+                                                 memory_order_relaxed));
+        if (slack < t->min_slack)
+            t->min_slack = slack;
+        if (slack < 0) {
+            t->misses++;
+            healthy = false;
+        }
+    }
+    return healthy;
+}
+
+size_t health_get_stats(struct health_group *g, struct health_stats *stats,
+                        size_t n)
+{
+    struct health_task *t;
+    size_t count = 0;
+    size_t i;
+    assert(g);
+    assert(stats || !n);
+    rtems_mutex_lock(&mtx);
+    for (i = 0; i < HEALTH_TASKS_MAX && count < n; i++) {
+        t = &g->tasks[i];
+        if (!atomic_load_explicit(&t->active, memory_order_relaxed))
+            continue;
+        stats[count].name = t->name;
+        stats[count].period = t->period;
+        stats[count].min_slack = t->min_slack;
+        stats[count].misses = t->misses;
+        count++;
+    }
+    rtems_mutex_unlock(&mtx);
+    return count;
+}
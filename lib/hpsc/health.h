@@ -0,0 +1,80 @@
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+
+// Health monitor: tasks register in a group with the period they promise to
+// check in within, then check in from their loops. A group is healthy while
+// every registered task has checked in within its period.
+// Groups are meant to be per CPU, with the CPU's watchdog kicked only while its
+// group is healthy (see watchdog_cpu_task_start), so a stuck task lets the WDT
+// expire instead of the kicker proving only that it runs itself.
+// Checking in is a single atomic store to the task's own slot, so is cheap and
+// interrupt-safe. Registering may _not_ be done from an interrupt context.
+
+#define HEALTH_TASKS_MAX 8 // per group
+
+// Fields are private, groups are exposed only to be allocated statically.
+struct health_task {
+    atomic_uint last; // check-in time, in ticks since boot
+    atomic_bool active;
+    const char *name;
+    rtems_interval period;
+    // updated by health_check only
+    int32_t min_slack;
+    uint32_t misses;
+};
+
+// Zero-initialized, e.g., static, is empty.
+struct health_group {
+    struct health_task tasks[HEALTH_TASKS_MAX];
+};
+
+struct health_stats {
+    const char *name;
+    rtems_interval period;
+    // least time left in the period seen by health_check, negative if late
+    int32_t min_slack;
+    uint32_t misses; // checks that found the task late
+};
+
+/**
+ * Register a task (or any other activity) that will check in at least every
+ * period_ticks. Counts as checked in now.
+ * Returns NULL if the group is full.
+ */
+struct health_task *health_register(struct health_group *g, const char *name,
+                                    rtems_interval period_ticks);
+
+/**
+ * Unregister a task, e.g., before it stops checking in.
+ */
+void health_unregister(struct health_task *t);
+
+/**
+ * Check in. May be called from an interrupt context.
+ */
+static inline void health_check_in(struct health_task *t)
+{
+    atomic_store_explicit(&t->last, rtems_clock_get_ticks_since_boot(),
+                          memory_order_relaxed);
+}
+
+/**
+ * Check that every task in a group checked in within its period, recording
+ * each one's slack. Not synchronized, a group must be checked by one task.
+ */
+bool health_check(struct health_group *g);
+
+/**
+ * Get the statistics of up to n registered tasks, returning how many.
+ */
+size_t health_get_stats(struct health_group *g, struct health_stats *stats,
+                        size_t n);
+
+#endif // HEALTH_H
@@ -6,27 +6,11 @@
 
 #include "hpsc-msg.h"
 
-// info is for debugging, use real data types if we need more detail
-#define LIFECYCLE_INFO_SIZE (HPSC_MSG_PAYLOAD_SIZE - sizeof(uint32_t))
-struct hpsc_msg_lifeycle_payload {
-    uint32_t status;
-    char info[LIFECYCLE_INFO_SIZE];
-};
-
-static void msg_fill(uint8_t *buf, enum hpsc_msg_type t, const void *payload,
-                     size_t psz)
-{
-    assert(buf);
-    assert(psz <= HPSC_MSG_PAYLOAD_SIZE);
-    buf[0] = t;
-    if (payload)
-        memcpy(&buf[HPSC_MSG_PAYLOAD_OFFSET], payload, psz);
-}
-
 void hpsc_msg_wdt_timeout(void *buf, size_t sz, unsigned int cpu)
 {
+    assert(buf);
     assert(sz == HPSC_MSG_SIZE);
-    msg_fill(buf, WATCHDOG_TIMEOUT, &cpu, sizeof(cpu));
+    hpsc_msg_wdt_timeout_encode(buf)->cpu = cpu;
 }
 
 void hpsc_msg_lifecycle(void *buf, size_t sz,
@@ -35,27 +19,54 @@ void hpsc_msg_lifecycle(void *buf, size_t sz,
 {
     // payload is the status enumeration and a string of debug data
     va_list args;
-    struct hpsc_msg_lifeycle_payload p = {
-        .status = status,
-        .info = {0}
-    };
+    struct hpsc_msg_lifecycle_payload *p;
+    assert(buf);
     assert(sz == HPSC_MSG_SIZE);
+    p = hpsc_msg_lifecycle_encode(buf);
+    p->status = status;
+    memset(p->info, 0, sizeof(p->info));
     if (fmt) {
         va_start(args, fmt);
-        vsnprintf(p.info, LIFECYCLE_INFO_SIZE - 1, fmt, args);
+        vsnprintf(p->info, sizeof(p->info) - 1, fmt, args);
         va_end(args);
     }
-    msg_fill(buf, LIFECYCLE, &p, sizeof(p));
+}
+
+void hpsc_msg_telemetry(void *buf, size_t sz, uint16_t event, uint8_t status,
+                        uint32_t str, const uint32_t *fields, size_t nfields)
+{
+    // fixed layout, so nothing to format
+    struct hpsc_msg_telemetry_payload *p;
+    assert(buf);
+    assert(sz == HPSC_MSG_SIZE);
+    assert(nfields <= HPSC_MSG_TELEMETRY_FIELDS_MAX);
+    p = hpsc_msg_telemetry_encode(buf);
+    p->event = event;
+    p->status = status;
+    p->nfields = nfields;
+    p->str = str;
+    if (nfields)
+        memcpy(p->fields, fields, nfields * sizeof(*fields));
 }
 
 void hpsc_msg_ping(void *buf, size_t sz, void *payload, size_t psz)
 {
+    struct hpsc_msg_ping_payload *p;
+    assert(buf);
     assert(sz == HPSC_MSG_SIZE);
-    msg_fill(buf, PING, payload, psz);
+    assert(psz <= HPSC_MSG_PAYLOAD_SIZE);
+    p = hpsc_msg_ping_encode(buf);
+    if (payload)
+        memcpy(p->data, payload, psz);
 }
 
 void hpsc_msg_pong(void *buf, size_t sz, void *payload, size_t psz)
 {
+    struct hpsc_msg_pong_payload *p;
+    assert(buf);
     assert(sz == HPSC_MSG_SIZE);
-    msg_fill(buf, PONG, payload, psz);
+    assert(psz <= HPSC_MSG_PAYLOAD_SIZE);
+    p = hpsc_msg_pong_encode(buf);
+    if (payload)
+        memcpy(p->data, payload, psz);
 }
@@ -1,6 +1,7 @@
 #ifndef HPSC_MSG_H
 #define HPSC_MSG_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define HPSC_MSG_SIZE 64
@@ -32,6 +33,8 @@ enum hpsc_msg_type {
     LIFECYCLE,
     // an enumerated/predefined action
     ACTION,
+    // binary notification, see telemetry.h
+    TELEMETRY,
     // enum counter
     HPSC_MSG_TYPE_COUNT
 };
@@ -41,12 +44,302 @@ enum hpsc_msg_lifecycle_status {
     LIFECYCLE_DOWN
 };
 
+/*
+ * Wire format: a header, then a payload whose layout depends on the type.
+ * Payloads are packed structs, and are accessed in place in the message buffer
+ * (e.g., a link buffer or shmem slot) with the codec functions below.
+ */
+struct hpsc_msg_hdr {
+    uint8_t type; // enum hpsc_msg_type
+    uint8_t reserved[3];
+} __attribute__((packed));
+
+struct hpsc_msg_ping_payload {
+    uint8_t data[HPSC_MSG_PAYLOAD_SIZE]; // echoed in the PONG
+} __attribute__((packed));
+
+struct hpsc_msg_pong_payload {
+    uint8_t data[HPSC_MSG_PAYLOAD_SIZE]; // from the PING
+} __attribute__((packed));
+
+struct hpsc_msg_wdt_timeout_payload {
+    uint32_t cpu;
+} __attribute__((packed));
+
+// info is for debugging, use real data types if we need more detail
+#define HPSC_MSG_LIFECYCLE_INFO_SIZE (HPSC_MSG_PAYLOAD_SIZE - sizeof(uint32_t))
+struct hpsc_msg_lifecycle_payload {
+    uint32_t status; // enum hpsc_msg_lifecycle_status
+    char info[HPSC_MSG_LIFECYCLE_INFO_SIZE];
+} __attribute__((packed));
+
+// Binary telemetry: an event with a status code, numeric fields, and a string
+// sent as an ID interned at build time, so the sender doesn't format anything
+// and receivers can aggregate events without parsing text.
+// Events, field names, and strings are in the decoder tables in telemetry.h.
+#define HPSC_MSG_TELEMETRY_FIELDS_MAX 13
+struct hpsc_msg_telemetry_payload {
+    uint16_t event; // enum telemetry_event
+    uint8_t status; // event-specific, e.g., enum hpsc_msg_lifecycle_status
+    uint8_t nfields;
+    uint32_t str; // enum telemetry_str
+    uint32_t fields[HPSC_MSG_TELEMETRY_FIELDS_MAX];
+} __attribute__((packed));
+
+// A memory range for READ_ADDR and WRITE_ADDR
+struct hpsc_msg_mem_seg {
+    uint32_t addr;
+    uint32_t len;
+} __attribute__((packed));
+
+#define HPSC_MSG_MEM_SEGS_MAX 6
+#define HPSC_MSG_MEM_READ_INLINE_SIZE HPSC_MSG_READ_VALUE_DATA_SIZE
+#define HPSC_MSG_MEM_WRITE_INLINE_SIZE \
+    (HPSC_MSG_PAYLOAD_SIZE - 2 * sizeof(uint32_t) - \
+     sizeof(struct hpsc_msg_mem_seg))
+
+enum hpsc_msg_mem_status {
+    MEM_STATUS_OK,
+    MEM_STATUS_INVALID, // malformed request
+    MEM_STATUS_DENIED,  // a range is not accessible
+    MEM_STATUS_FAILED
+};
+
+// The segments are read in order and concatenated, into the memory at 'buf',
+// or into the READ_VALUE reply if 'buf' is 0
+struct hpsc_msg_read_addr_payload {
+    uint32_t buf;
+    uint32_t nsegs;
+    struct hpsc_msg_mem_seg segs[HPSC_MSG_MEM_SEGS_MAX];
+} __attribute__((packed));
+
+// The segments are written in order from the memory at 'buf', or if 'buf' is
+// 0, the single segment is written from the inline data
+struct hpsc_msg_write_addr_payload {
+    uint32_t buf;
+    uint32_t nsegs;
+    union {
+        struct hpsc_msg_mem_seg segs[HPSC_MSG_MEM_SEGS_MAX];
+        struct {
+            struct hpsc_msg_mem_seg seg;
+            uint8_t data[HPSC_MSG_MEM_WRITE_INLINE_SIZE];
+        } inl;
+    };
+} __attribute__((packed));
+
+enum hpsc_msg_file_op {
+    FILE_OP_OPEN,  // open 'path', for the reply's handle
+    FILE_OP_XFER,  // read or write 'xfer' with 'handle'
+    FILE_OP_CLOSE  // close 'handle'
+};
+
+enum hpsc_msg_file_status {
+    FILE_STATUS_OK,
+    FILE_STATUS_INVALID,   // malformed request, or bad handle
+    FILE_STATUS_DENIED,    // path or buffer is not accessible
+    FILE_STATUS_NOT_FOUND,
+    FILE_STATUS_BUSY,      // no free handles
+    FILE_STATUS_FAILED
+};
+
+// WRITE_FILE open flags
+#define HPSC_MSG_FILE_CREATE 0x1
+#define HPSC_MSG_FILE_TRUNC  0x2
+
+#define HPSC_MSG_FILE_PATH_SIZE (HPSC_MSG_PAYLOAD_SIZE - 4)
+#define HPSC_MSG_FILE_WRITE_INLINE_SIZE \
+    (HPSC_MSG_FILE_PATH_SIZE - sizeof(struct hpsc_msg_file_xfer))
+
+// A chunk of a file at an explicit offset, so chunks may be requested without
+// waiting for replies (a window), and transfers may resume at any offset.
+// The data is in the memory at 'buf', or inline in the message if 'buf' is 0.
+struct hpsc_msg_file_xfer {
+    uint32_t offset;
+    uint32_t len;
+    uint32_t buf;
+} __attribute__((packed));
+
+// Replies are READ_VALUE, with the file size for FILE_OP_OPEN, or the chunk's
+// data, which may be shorter than requested (and empty at end of file).
+struct hpsc_msg_read_file_payload {
+    uint8_t op; // enum hpsc_msg_file_op
+    uint8_t handle;
+    uint8_t reserved[2];
+    union {
+        char path[HPSC_MSG_FILE_PATH_SIZE]; // NUL-terminated
+        struct hpsc_msg_file_xfer xfer;
+    };
+} __attribute__((packed));
+
+// Replies are WRITE_STATUS.
+struct hpsc_msg_write_file_payload {
+    uint8_t op; // enum hpsc_msg_file_op
+    uint8_t handle;
+    uint8_t flags; // for FILE_OP_OPEN
+    uint8_t reserved;
+    union {
+        char path[HPSC_MSG_FILE_PATH_SIZE]; // NUL-terminated
+        struct {
+            struct hpsc_msg_file_xfer xfer;
+            uint8_t data[HPSC_MSG_FILE_WRITE_INLINE_SIZE];
+        };
+    };
+} __attribute__((packed));
+
+// Properties are named by IDs hashed from their names (see hpsc_msg_prop_id),
+// so both sides agree on IDs without a shared registry.
+enum hpsc_msg_prop_type {
+    PROP_TYPE_NONE, // no such property
+    PROP_TYPE_U32,
+    PROP_TYPE_I32,
+    PROP_TYPE_BOOL
+};
+
+enum hpsc_msg_prop_status {
+    PROP_STATUS_OK,
+    PROP_STATUS_INVALID,   // malformed request, or a value of the wrong type
+    PROP_STATUS_NOT_FOUND,
+    PROP_STATUS_DENIED     // property is read-only
+};
+
+#define HPSC_MSG_PROP_READS_MAX 8
+#define HPSC_MSG_PROP_WRITES_MAX 6
+
+struct hpsc_msg_prop {
+    uint32_t id;
+    uint32_t value;
+} __attribute__((packed));
+
+// Replies are READ_VALUE, with the values and types of all the properties
+// (PROP_TYPE_NONE for those not found).
+struct hpsc_msg_read_prop_payload {
+    uint8_t count;
+    uint8_t reserved[3];
+    uint32_t ids[HPSC_MSG_PROP_READS_MAX];
+} __attribute__((packed));
+
+// Properties are written in order, up to the first failure, and the values
+// must be of the given types. Replies are WRITE_STATUS.
+struct hpsc_msg_write_prop_payload {
+    uint8_t count;
+    uint8_t types[HPSC_MSG_PROP_WRITES_MAX]; // enum hpsc_msg_prop_type
+    uint8_t reserved;
+    struct hpsc_msg_prop props[HPSC_MSG_PROP_WRITES_MAX];
+} __attribute__((packed));
+
+// READ_VALUE data for READ_PROP
+struct hpsc_msg_prop_values {
+    uint32_t values[HPSC_MSG_PROP_READS_MAX];
+    uint8_t types[HPSC_MSG_PROP_READS_MAX]; // enum hpsc_msg_prop_type
+} __attribute__((packed));
+
+#define HPSC_MSG_READ_VALUE_DATA_SIZE (HPSC_MSG_PAYLOAD_SIZE - 12)
+
+// Reply to READ_ADDR, READ_FILE and READ_PROP, identifying the request type in
+// 'id'
+struct hpsc_msg_read_value_payload {
+    uint8_t id; // enum hpsc_msg_type of the request
+    uint8_t status; // enum hpsc_msg_{mem,file,prop}_status
+    uint8_t handle; // READ_FILE
+    uint8_t reserved;
+    uint32_t offset; // READ_FILE: file offset of the data
+    uint32_t len; // total bytes read, or READ_PROP: properties read
+    union {
+        uint8_t data[HPSC_MSG_READ_VALUE_DATA_SIZE]; // if read inline
+        struct hpsc_msg_prop_values props; // READ_PROP
+    };
+} __attribute__((packed));
+
+// Reply to WRITE_ADDR, WRITE_FILE and WRITE_PROP, identifying the request type
+// in 'id'
+struct hpsc_msg_write_status_payload {
+    uint8_t id; // enum hpsc_msg_type of the request
+    uint8_t status; // enum hpsc_msg_{mem,file,prop}_status
+    uint8_t handle; // WRITE_FILE
+    uint8_t reserved;
+    uint32_t offset; // WRITE_FILE: file offset of the data
+    uint32_t len; // total bytes written, or WRITE_PROP: properties written
+} __attribute__((packed));
+
+// Payload descriptors: (type, name), for struct hpsc_msg_<name>_payload
+#define HPSC_MSG_PAYLOADS(X) \
+    X(PING, ping) \
+    X(PONG, pong) \
+    X(READ_VALUE, read_value) \
+    X(WRITE_STATUS, write_status) \
+    X(READ_ADDR, read_addr) \
+    X(WRITE_ADDR, write_addr) \
+    X(READ_FILE, read_file) \
+    X(WRITE_FILE, write_file) \
+    X(READ_PROP, read_prop) \
+    X(WRITE_PROP, write_prop) \
+    X(WATCHDOG_TIMEOUT, wdt_timeout) \
+    X(LIFECYCLE, lifecycle) \
+    X(TELEMETRY, telemetry)
+
+_Static_assert(sizeof(struct hpsc_msg_hdr) == HPSC_MSG_PAYLOAD_OFFSET,
+               "hpsc_msg_hdr size must be HPSC_MSG_PAYLOAD_OFFSET");
+_Static_assert(sizeof(struct hpsc_msg_prop_values) <=
+                   HPSC_MSG_READ_VALUE_DATA_SIZE,
+               "hpsc_msg_prop_values too large");
+
+/*
+ * For each descriptor, defines:
+ *   struct hpsc_msg_<name>_payload *hpsc_msg_<name>_encode(void *buf)
+ *     sets buf's type and returns its payload, for the caller to fill in
+ *   const struct hpsc_msg_<name>_payload *hpsc_msg_<name>_decode(const void *)
+ *     returns buf's payload, or NULL if buf isn't of the type
+ * where buf must be HPSC_MSG_SIZE bytes.
+ */
+#define HPSC_MSG_CODEC(t, name) \
+    _Static_assert(sizeof(struct hpsc_msg_##name##_payload) <= \
+                       HPSC_MSG_PAYLOAD_SIZE, \
+                   "hpsc_msg_" #name "_payload too large"); \
+    static inline struct hpsc_msg_##name##_payload * \
+    hpsc_msg_##name##_encode(void *buf) \
+    { \
+        ((struct hpsc_msg_hdr *) buf)->type = t; \
+        return (struct hpsc_msg_##name##_payload *) \
+            ((uint8_t *) buf + HPSC_MSG_PAYLOAD_OFFSET); \
+    } \
+    static inline const struct hpsc_msg_##name##_payload * \
+    hpsc_msg_##name##_decode(const void *buf) \
+    { \
+        if (((const struct hpsc_msg_hdr *) buf)->type != t) \
+            return NULL; \
+        return (const struct hpsc_msg_##name##_payload *) \
+            ((const uint8_t *) buf + HPSC_MSG_PAYLOAD_OFFSET); \
+    }
+HPSC_MSG_PAYLOADS(HPSC_MSG_CODEC)
+
+static inline enum hpsc_msg_type hpsc_msg_type(const void *buf)
+{
+    return ((const struct hpsc_msg_hdr *) buf)->type;
+}
+
+/*
+ * A property ID: the 32-bit FNV-1a hash of the property's name, e.g.,
+ * "rtps.cpus". 0 is not a valid ID, so is remapped.
+ */
+static inline uint32_t hpsc_msg_prop_id(const char *name)
+{
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= (uint8_t) *name++;
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
 void hpsc_msg_wdt_timeout(void *buf, size_t sz, unsigned int cpu);
 
 void hpsc_msg_lifecycle(void *buf, size_t sz,
                         enum hpsc_msg_lifecycle_status status,
                         const char *fmt, ...);
 
+void hpsc_msg_telemetry(void *buf, size_t sz, uint16_t event, uint8_t status,
+                        uint32_t str, const uint32_t *fields, size_t nfields);
+
 void hpsc_msg_ping(void *buf, size_t sz, void *payload, size_t psz);
 
 void hpsc_msg_pong(void *buf, size_t sz, void *payload, size_t psz);
@@ -0,0 +1,51 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "latency.h"
+
+void latency_hist_add(struct latency_hist *h, uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    unsigned b = 0;
+    assert(h);
+    while (us && b < LATENCY_HIST_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    h->buckets[b]++;
+    h->count++;
+    h->total_ns += ns;
+    if (ns > h->max_ns)
+        h->max_ns = ns;
+}
+
+void latency_hist_reset(struct latency_hist *h)
+{
+    assert(h);
+    memset(h, 0, sizeof(*h));
+}
+
+void latency_hist_print(const struct latency_hist *h, const char *label)
+{
+    unsigned b;
+    assert(h);
+    printf("%s: count %"PRIu32, label, h->count);
+    if (!h->count) {
+        printf("\n");
+        return;
+    }
+    printf(" avg %"PRIu64" ns max %"PRIu64" ns\n", h->total_ns / h->count,
+           h->max_ns);
+    for (b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+        if (!h->buckets[b])
+            continue;
+        if (!b)
+            printf("    < 1 us: %"PRIu32"\n", h->buckets[b]);
+        else if (b == LATENCY_HIST_BUCKETS - 1)
+            printf("    >= %lu us: %"PRIu32"\n", 1ul << (b - 1), h->buckets[b]);
+        else
+            printf("    < %lu us: %"PRIu32"\n", 1ul << b, h->buckets[b]);
+    }
+}
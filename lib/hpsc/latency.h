@@ -0,0 +1,32 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+// Bucket 0 counts samples under 1 us, bucket i (> 0) those in
+// [2^(i-1), 2^i) us, and the last bucket also counts everything longer.
+#define LATENCY_HIST_BUCKETS 20
+
+struct latency_hist {
+    uint32_t count;
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+/**
+ * Add a sample. Not synchronized, callers must serialize updates.
+ */
+void latency_hist_add(struct latency_hist *h, uint64_t ns);
+
+/**
+ * Clear all samples.
+ */
+void latency_hist_reset(struct latency_hist *h);
+
+/**
+ * Print a summary and the non-empty buckets to stdout, prefixed by label.
+ */
+void latency_hist_print(const struct latency_hist *h, const char *label);
+
+#endif // LATENCY_H
@@ -7,6 +7,7 @@
 #include <rtems/bspIo.h>
 #include <rtems/irq-extension.h>
 
+#include "doorbell.h"
 #include "link.h"
 #include "link-shmem.h"
 #include "shmem.h"
@@ -17,6 +18,8 @@ struct link_shmem {
     struct shmem *shmem_in;
     struct shmem_poll *sp_recv;
     struct shmem_poll *sp_ack;
+    struct doorbell *db;
+    rtems_interrupt_handler recv_cb;
 };
 
 
@@ -28,11 +31,24 @@ static void link_shmem_ack(void *arg)
     shmem_set_ack(slink->shmem_out, false);
 }
 
+static void link_shmem_doorbell(void *arg)
+{
+    // the remote rings for both new messages and ACKs, and rings may coalesce
+    struct link *link = arg;
+    struct link_shmem *slink = link->priv;
+    if (shmem_is_new(slink->shmem_in))
+        slink->recv_cb(link);
+    if (shmem_is_ack(slink->shmem_out))
+        link_shmem_ack(link);
+}
+
 static size_t link_shmem_write(struct link *link, void *buf, size_t sz)
 {
     struct link_shmem *slink = link->priv;
     size_t rc = shmem_write(slink->shmem_out, buf, sz);
     shmem_set_new(slink->shmem_out, true);
+    if (slink->db)
+        doorbell_ring(slink->db);
     return rc;
 }
 
@@ -42,6 +58,8 @@ static size_t link_shmem_read(struct link *link, void *buf, size_t sz)
     size_t rc = shmem_read(slink->shmem_in, buf, sz);
     shmem_set_new(slink->shmem_in, false);
     shmem_set_ack(slink->shmem_in, true);
+    if (slink->db)
+        doorbell_ring(slink->db);
     return rc;
 }
 
@@ -51,12 +69,18 @@ static int link_shmem_close(struct link *link)
     int rc = 0;
     rtems_status_code sc;
     printk("%s: close\n", link->name);
-    sc = shmem_poll_task_destroy(slink->sp_ack);
-    if (sc != RTEMS_SUCCESSFUL)
-        rc = -1;
-    sc = shmem_poll_task_destroy(slink->sp_recv);
-    if (sc != RTEMS_SUCCESSFUL)
-        rc = -1;
+    if (slink->db) {
+        doorbell_unsubscribe(slink->db);
+        if (doorbell_close(slink->db))
+            rc = -1;
+    } else {
+        sc = shmem_poll_task_destroy(slink->sp_ack);
+        if (sc != RTEMS_SUCCESSFUL)
+            rc = -1;
+        sc = shmem_poll_task_destroy(slink->sp_recv);
+        if (sc != RTEMS_SUCCESSFUL)
+            rc = -1;
+    }
     shmem_close(slink->shmem_out);
     shmem_close(slink->shmem_in);
     free(slink);
@@ -64,38 +88,23 @@ static int link_shmem_close(struct link *link)
     return rc;
 }
 
-static int link_shmem_init(
+static int link_shmem_init_poll(
     struct link_shmem *slink,
     struct link *link,
-    uintptr_t addr_out,
-    uintptr_t addr_in,
-    bool is_server,
     rtems_interval poll_ticks,
     rtems_id tid_recv,
     rtems_id tid_ack
 )
 {
     rtems_status_code sc;
-    slink->shmem_out = shmem_open(addr_out);
-    if (!slink->shmem_out)
-        return -1;
-    slink->shmem_in = shmem_open(addr_in);
-    if (!slink->shmem_in)
-        goto free_out;
     // start listening tasks
-    if (is_server) {
-        sc = shmem_poll_task_start(&slink->sp_recv, slink->shmem_in,
-                                   poll_ticks, HPSC_SHMEM_STATUS_BIT_NEW,
-                                   tid_recv, link_recv_cmd, link);
-    } else {
-        sc = shmem_poll_task_start(&slink->sp_recv, slink->shmem_in,
-                                   poll_ticks, HPSC_SHMEM_STATUS_BIT_NEW,
-                                   tid_recv, link_recv_reply, link);
-    }
+    sc = shmem_poll_task_start(&slink->sp_recv, slink->shmem_in,
+                               poll_ticks, HPSC_SHMEM_STATUS_BIT_NEW,
+                               tid_recv, slink->recv_cb, link);
     if (sc != RTEMS_SUCCESSFUL) {
         printk("Failed to create receive polling task: %s\n",
                rtems_status_text(sc));
-        goto free_all;
+        return -1;
     }
     sc = shmem_poll_task_start(&slink->sp_ack, slink->shmem_out, poll_ticks,
                                HPSC_SHMEM_STATUS_BIT_ACK,
@@ -103,12 +112,42 @@ static int link_shmem_init(
     if (sc != RTEMS_SUCCESSFUL) {
         printk("Failed to create ACK polling task: %s\n",
                rtems_status_text(sc));
-        goto stop_recv_task;
+        shmem_poll_task_destroy(slink->sp_recv);
+        return -1;
     }
     return 0;
+}
+
+static int link_shmem_init(
+    struct link_shmem *slink,
+    struct link *link,
+    uintptr_t addr_out,
+    uintptr_t addr_in,
+    enum shmem_mode mode,
+    bool is_server,
+    rtems_interval poll_ticks,
+    rtems_id tid_recv,
+    rtems_id tid_ack,
+    struct doorbell *db
+)
+{
+    slink->shmem_out = shmem_open(addr_out, mode);
+    if (!slink->shmem_out)
+        return -1;
+    slink->shmem_in = shmem_open(addr_in, mode);
+    if (!slink->shmem_in)
+        goto free_out;
+    slink->sp_recv = NULL;
+    slink->sp_ack = NULL;
+    slink->db = db;
+    slink->recv_cb = is_server ? link_recv_cmd : link_recv_reply;
+    if (db)
+        doorbell_subscribe(db, link_shmem_doorbell, link);
+    else if (link_shmem_init_poll(slink, link, poll_ticks, tid_recv,
+                                    tid_ack))
+        goto free_all;
+    return 0;
 
-stop_recv_task:
-    shmem_poll_task_destroy(slink->sp_recv);
 free_all:
     shmem_close(slink->shmem_in);
 free_out:
@@ -120,10 +159,12 @@ struct link *link_shmem_connect(
     const char* name,
     uintptr_t addr_out,
     uintptr_t addr_in,
+    enum shmem_mode mode,
     bool is_server,
     rtems_interval poll_ticks,
     rtems_id tid_recv,
-    rtems_id tid_ack
+    rtems_id tid_ack,
+    struct doorbell *db
 )
 {
     struct link_shmem *slink;
@@ -131,11 +172,17 @@ struct link *link_shmem_connect(
     assert(name);
     assert(addr_out);
     assert(addr_in);
+    // polling tasks and doorbell callbacks would race to handle messages
+    assert(!db || (tid_recv == RTEMS_ID_NONE && tid_ack == RTEMS_ID_NONE));
 
     printk("%s: connect\n", name);
     printk("\taddr_out   = 0x%"PRIxPTR"\n", (uintptr_t) addr_out);
     printk("\taddr_in    = 0x%"PRIxPTR"\n", (uintptr_t) addr_in);
-    printk("\tpoll_ticks = %u\n", poll_ticks);
+    printk("\tcacheable  = %d\n", mode == SHMEM_MODE_CACHEABLE);
+    if (db)
+        printk("\tdoorbell   = %s\n", db->name);
+    else
+        printk("\tpoll_ticks = %u\n", poll_ticks);
 
     link = malloc(sizeof(*link));
     if (!link)
@@ -149,8 +196,8 @@ struct link *link_shmem_connect(
     link->read = link_shmem_read;
     link->close = link_shmem_close;
 
-    if (link_shmem_init(slink, link, addr_out, addr_in, is_server, poll_ticks,
-                        tid_recv, tid_ack))
+    if (link_shmem_init(slink, link, addr_out, addr_in, mode, is_server,
+                        poll_ticks, tid_recv, tid_ack, db))
         goto free_links;
 
     return link;
@@ -6,16 +6,32 @@
 
 #include <rtems.h>
 
+#include "doorbell.h"
 #include "link.h"
+#include "shmem.h"
 
+/**
+ * Connect a shared memory link.
+ * Without a doorbell, the tid_recv and tid_ack tasks poll the shared memory
+ * regions every poll_ticks to notice new messages and ACKs.
+ * With a doorbell, the link rings the remote after every write to the shared
+ * memory regions and handles the remote's rings in an interrupt context, so
+ * tid_recv and tid_ack must be RTEMS_ID_NONE (poll_ticks is ignored).
+ * The remote must ring the doorbell for its writes too; rings that arrive
+ * before the link is connected are dropped.
+ * The link takes ownership of the doorbell and closes it on disconnect.
+ * The mode applies to both shared memory regions (see shmem_open).
+ */
 struct link *link_shmem_connect(
     const char* name,
     uintptr_t addr_out,
     uintptr_t addr_in,
+    enum shmem_mode mode,
     bool is_server,
     rtems_interval poll_ticks,
     rtems_id tid_recv,
-    rtems_id tid_ack
+    rtems_id tid_ack,
+    struct doorbell *db
 );
 
 #endif // LINK_SHMEM_H
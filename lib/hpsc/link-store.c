@@ -12,7 +12,10 @@
 
 struct link_store_node {
     rtems_chain_node node; // must be at the top of the struct to cast
-    struct link *link;
+    const char *name;
+    struct link *link; // NULL until a lazy link is connected
+    link_store_connect_fn connect;
+    void *connect_arg;
 };
 
 static RTEMS_CHAIN_DEFINE_EMPTY(lchain);
@@ -26,28 +29,47 @@ static struct link_store_node *link_store_node_get(const char *name)
          !rtems_chain_is_tail(&lchain, node);
          node = rtems_chain_next(node)) {
         snode = (struct link_store_node *)node;
-        if ((name && !snode->link->name) || (!name && snode->link->name))
+        if ((name && !snode->name) || (!name && snode->name))
             continue;
-        if ((!name && !snode->link->name) || !strcmp(name, snode->link->name))
+        if ((!name && !snode->name) || !strcmp(name, snode->name))
             return snode;
     }
     return NULL;
 }
 
-rtems_status_code link_store_append(struct link *link)
+static rtems_status_code link_store_append_node(const char *name,
+                                                struct link *link,
+                                                link_store_connect_fn connect,
+                                                void *arg)
 {
     struct link_store_node *snode;
-    assert(link);
     snode = malloc(sizeof(struct link_store_node));
     if (!snode)
         return RTEMS_NO_MEMORY;
+    snode->name = name;
     snode->link = link;
+    snode->connect = connect;
+    snode->connect_arg = arg;
     rtems_mutex_lock(&lmtx);
     rtems_chain_append(&lchain, &snode->node);
     rtems_mutex_unlock(&lmtx);
     return RTEMS_SUCCESSFUL;
 }
 
+rtems_status_code link_store_append(struct link *link)
+{
+    assert(link);
+    return link_store_append_node(link->name, link, NULL, NULL);
+}
+
+rtems_status_code link_store_append_lazy(const char *name,
+                                         link_store_connect_fn connect,
+                                         void *arg)
+{
+    assert(connect);
+    return link_store_append_node(name, NULL, connect, arg);
+}
+
 bool link_store_contains(const char *name)
 {
     bool rc;
@@ -69,10 +91,29 @@ bool link_store_is_empty(void)
 struct link *link_store_get(const char *name)
 {
     struct link_store_node *snode;
+    struct link *link = NULL;
+    rtems_mutex_lock(&lmtx);
+    snode = link_store_node_get(name);
+    if (snode) {
+        // connect under the lock, so concurrent first uses connect only once
+        if (!snode->link)
+            snode->link = snode->connect(snode->connect_arg);
+        link = snode->link;
+    }
+    rtems_mutex_unlock(&lmtx);
+    return link;
+}
+
+struct link *link_store_peek(const char *name)
+{
+    struct link_store_node *snode;
+    struct link *link = NULL;
     rtems_mutex_lock(&lmtx);
     snode = link_store_node_get(name);
+    if (snode)
+        link = snode->link;
     rtems_mutex_unlock(&lmtx);
-    return snode ? snode->link : NULL;
+    return link;
 }
 
 struct link *link_store_extract(const char *name)
@@ -95,13 +136,15 @@ struct link *link_store_extract_first(void)
     struct link *link = NULL;
     struct link_store_node *snode;
     rtems_chain_node* node;
-    rtems_mutex_lock(&lmtx);
-    node = rtems_chain_get(&lchain);
-    rtems_mutex_unlock(&lmtx);
-    if (node) {
-        snode = ((struct link_store_node *)node);
-        link = snode->link;
-        free(snode);
-    }
+    do {
+        rtems_mutex_lock(&lmtx);
+        node = rtems_chain_get(&lchain);
+        rtems_mutex_unlock(&lmtx);
+        if (node) {
+            snode = ((struct link_store_node *)node);
+            link = snode->link;
+            free(snode);
+        }
+    } while (node && !link);
     return link;
 }
@@ -11,13 +11,29 @@
 // synchronization beyond maintaining internal consistency.
 // Link pointers are stored in a chain (linked list), so access time is O(n).
 // If link names are not unique, "get"/"extract" will return the first match.
+// Links may also be registered lazily, to be connected on first use, so links
+// that are seldom or never used don't cost boot time, tasks or poll wakeups.
 // Link store functions may _not_ be called from an interrupt context.
 
+/**
+ * Connects a lazily registered link, returning NULL on failure.
+ */
+typedef struct link *(*link_store_connect_fn)(void *arg);
+
 /**
  * Append a link to the store.
  */
 rtems_status_code link_store_append(struct link *link);
 
+/**
+ * Append a link to the store by name, to be connected on the first
+ * link_store_get of the name. If connecting fails, that get returns NULL and
+ * the next one retries. The name isn't copied.
+ */
+rtems_status_code link_store_append_lazy(const char *name,
+                                         link_store_connect_fn connect,
+                                         void *arg);
+
 /**
  * Check if the store contains a link with the provided name.
  */
@@ -30,16 +46,26 @@ bool link_store_is_empty(void);
 
 /**
  * Get a link from the store with the provided name, or NULL.
+ * Connects a lazy link, blocking other link store users meanwhile.
  */
 struct link *link_store_get(const char *name);
 
+/**
+ * Get a link from the store with the provided name without connecting it, so
+ * NULL for a lazy link that isn't connected yet, as for no link at all.
+ * Use link_store_contains to tell them apart.
+ */
+struct link *link_store_peek(const char *name);
+
 /**
  * Remove a link from the store with the provided name, or NULL.
+ * Returns NULL for a lazy link that was never connected, which is just removed.
  */
 struct link *link_store_extract(const char *name);
 
 /**
  * Remove the first link from the store, or NULL.
+ * Lazy links that were never connected are removed and skipped.
  * Primarily used in a loop to drain empty the store.
  */
 struct link *link_store_extract_first(void);
@@ -1,9 +1,11 @@
 #include <assert.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <unistd.h>
 
 #include <rtems.h>
 #include <rtems/bspIo.h>
+#include <rtems/counter.h>
 
 #include "command.h"
 #include "link.h"
@@ -81,6 +83,139 @@ ssize_t link_request(struct link *link,
     return _link_request_recv(link, rtimeout_ticks);
 }
 
+static void link_tx_notify(rtems_id tid, rtems_event_set event)
+{
+    // the task may have given up on the link and exited, which is harmless
+    if (tid != RTEMS_ID_NONE)
+        rtems_event_send(tid, event);
+}
+
+// tx_lock held; returns the task (if any) waiting for the link, to notify
+static void link_tx_release_unsafe(struct link *link, rtems_id *tid,
+                                   rtems_event_set *event)
+{
+    link->tx_owner = LINK_TX_IDLE;
+    *tid = link->tx_waiter_tid;
+    *event = link->tx_waiter_event;
+    link->tx_waiter_tid = RTEMS_ID_NONE;
+}
+
+ssize_t link_send_async(struct link *link, void *buf, size_t sz,
+                        rtems_event_set event_ack)
+{
+    rtems_interrupt_lock_context lock_context;
+    bool claimed = false;
+    size_t rc;
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    if (link->tx_owner == LINK_TX_IDLE) {
+        link->tx_owner = LINK_TX_TASK;
+        link->tx_tid = rtems_task_self();
+        link->tx_event = event_ack;
+        claimed = true;
+    } else {
+        link->tx_waiter_tid = rtems_task_self();
+        link->tx_waiter_event = event_ack;
+    }
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    if (!claimed)
+        return 0;
+    rc = link->write(link, buf, sz);
+    if (!rc) {
+        link_send_end(link);
+        return -1;
+    }
+    return rc;
+}
+
+bool link_send_acked(struct link *link)
+{
+    rtems_interrupt_lock_context lock_context;
+    bool acked;
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    acked = link->tx_owner == LINK_TX_TASK_ACKED;
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    return acked;
+}
+
+void link_send_end(struct link *link)
+{
+    rtems_interrupt_lock_context lock_context;
+    rtems_id tid = RTEMS_ID_NONE;
+    rtems_event_set event = 0;
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    // if not ACKed, the caller gave up on it
+    if (link->tx_owner == LINK_TX_TASK ||
+        link->tx_owner == LINK_TX_TASK_ACKED)
+        link_tx_release_unsafe(link, &tid, &event);
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    link_tx_notify(tid, event);
+}
+
+void link_send_cancel(struct link *link)
+{
+    rtems_interrupt_lock_context lock_context;
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    if (link->tx_waiter_tid == rtems_task_self())
+        link->tx_waiter_tid = RTEMS_ID_NONE;
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+}
+
+bool link_tx_claim(struct link *link)
+{
+    rtems_interrupt_lock_context lock_context;
+    bool claimed = false;
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    if (link->tx_owner == LINK_TX_IDLE) {
+        link->tx_owner = LINK_TX_ISR;
+        link->tx_claimed = rtems_clock_get_ticks_since_boot();
+        claimed = true;
+    }
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    return claimed;
+}
+
+void link_tx_release(struct link *link)
+{
+    rtems_interrupt_lock_context lock_context;
+    rtems_id tid = RTEMS_ID_NONE;
+    rtems_event_set event = 0;
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    if (link->tx_owner == LINK_TX_ISR)
+        link_tx_release_unsafe(link, &tid, &event);
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    link_tx_notify(tid, event);
+}
+
+bool link_tx_release_stale(struct link *link, rtems_interval ticks)
+{
+    rtems_interrupt_lock_context lock_context;
+    rtems_id tid = RTEMS_ID_NONE;
+    rtems_event_set event = 0;
+    bool released = false;
+    assert(ticks);
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    if (link->tx_owner == LINK_TX_ISR &&
+        rtems_clock_get_ticks_since_boot() - link->tx_claimed >= ticks) {
+        link_tx_release_unsafe(link, &tid, &event);
+        released = true;
+    }
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    link_tx_notify(tid, event);
+    if (released)
+        printk("%s: released stale claim\n", link->name);
+    return released;
+}
+
+size_t link_send_claimed(struct link *link, void *buf, size_t sz)
+{
+    size_t rc;
+    assert(link->tx_owner == LINK_TX_ISR);
+    rc = link->write(link, buf, sz);
+    if (!rc)
+        link_tx_release(link);
+    return rc;
+}
+
 int link_disconnect(struct link *link)
 {
     return link->close(link);
@@ -91,21 +226,57 @@ void link_init(struct link *link, const char *name, void *priv)
     link->rctx.tid_requester = RTEMS_ID_NONE;
     link->rctx.tx_acked = false;
     link->rctx.reply = NULL;
+    rtems_interrupt_lock_initialize(&link->tx_lock, "Link TX");
+    link->tx_owner = LINK_TX_IDLE;
+    link->tx_tid = RTEMS_ID_NONE;
+    link->tx_waiter_tid = RTEMS_ID_NONE;
     link->name = name;
     link->priv = priv;
+    link->cmds_dropped = 0;
+    link->cmd_prio = CMD_PRIO_DEFAULT;
+    link->cmd_server = NULL;
+    latency_hist_reset(&link->cmd_latency);
+}
+
+void link_set_cmd_server(struct link *link, struct cmd_server *server)
+{
+    assert(link);
+    link->cmd_server = server;
 }
 
 void link_recv_cmd(void *arg)
 {
     struct link *link = arg;
-    struct cmd cmd = {
+    rtems_counter_ticks recv = rtems_counter_read();
+    struct cmd_server *server = cmd_server_for_link(link);
+    struct cmd *cmd = cmd_reserve(server, link);
+    // for when the queue is full, the fast path may still handle it
+    struct cmd cmd_unqueued = {
         .link = link,
         .msg = { 0 }
     };
+    int rc = -1;
     printk("%s: recv_cmd\n", link->name);
-    link->read(link, cmd.msg, sizeof(cmd.msg));
-    if (cmd_enqueue(&cmd))
-        rtems_panic("%s: recv_cmd: failed to enqueue command", link->name);
+    if (!cmd)
+        cmd = &cmd_unqueued;
+    // always read, so the remote can send again
+    // when reserved, straight into the queue slot, where it's handled
+    cmd->ts[CMD_TS_RECV] = recv;
+    link->read(link, cmd->msg, sizeof(cmd->msg));
+    if (cmd_handle_isr(server, cmd)) {
+        if (cmd != &cmd_unqueued)
+            cmd_cancel(server, cmd);
+        return;
+    }
+    if (cmd != &cmd_unqueued)
+        rc = cmd_commit(server, cmd);
+    if (rc < 0) {
+        link->cmds_dropped++;
+        printk("%s: recv_cmd: dropped command (total %"PRIu32")\n", link->name,
+               link->cmds_dropped);
+    } else if (rc == CMD_ENQUEUE_HIGH_WATERMARK) {
+        printk("%s: recv_cmd: command queue is filling up\n", link->name);
+    }
 }
 
 void link_recv_reply(void *arg)
@@ -128,9 +299,33 @@ void link_ack(void *arg)
 {
     struct link *link = arg;
     rtems_status_code sc;
+    rtems_interrupt_lock_context lock_context;
+    rtems_id tid = RTEMS_ID_NONE;
+    rtems_event_set event = 0;
+    bool requested = false;
     printk("%s: ACK\n", link->name);
-    link->rctx.tx_acked = true;
-    if (link->rctx.tid_requester != RTEMS_ID_NONE) {
+    rtems_interrupt_lock_acquire(&link->tx_lock, &lock_context);
+    switch (link->tx_owner) {
+    case LINK_TX_TASK:
+        // the link stays claimed until the task sees the ACK
+        link->tx_owner = LINK_TX_TASK_ACKED;
+        tid = link->tx_tid;
+        event = link->tx_event;
+        break;
+    case LINK_TX_ISR:
+        link_tx_release_unsafe(link, &tid, &event);
+        break;
+    case LINK_TX_IDLE:
+        // link_request_send and link_request don't claim the link
+        link->rctx.tx_acked = true;
+        requested = true;
+        break;
+    default:
+        break; // already ACKed
+    }
+    rtems_interrupt_lock_release(&link->tx_lock, &lock_context);
+    link_tx_notify(tid, event);
+    if (requested && link->rctx.tid_requester != RTEMS_ID_NONE) {
         sc = rtems_event_send(link->rctx.tid_requester, link->rctx.event_wait);
         if (sc != RTEMS_SUCCESSFUL)
             // there was a race with send timeout and clearing tid_requester
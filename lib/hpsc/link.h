@@ -2,10 +2,15 @@
 #define LINK_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 
 #include <rtems.h>
 
+#include "latency.h"
+
+struct cmd_server;
+
 struct link_request_ctx {
     rtems_id tid_requester;
     rtems_event_set event_wait;
@@ -15,14 +20,34 @@ struct link_request_ctx {
     size_t reply_sz_read;
 };
 
+// who may write to the link until the remote ACKs
+enum link_tx_owner {
+    LINK_TX_IDLE,
+    LINK_TX_TASK, // link_send_async
+    LINK_TX_TASK_ACKED, // until link_send_end
+    LINK_TX_ISR   // link_tx_claim
+};
+
 /**
  * Link implementations populate this struct.
  * Link users use the functions described below, NOT the function pointers.
  */
 struct link {
     volatile struct link_request_ctx rctx; // may be modified in interrupts
+    // link_send_async and link_tx_claim state, under tx_lock
+    rtems_interrupt_lock tx_lock;
+    enum link_tx_owner tx_owner;
+    rtems_id tx_tid; // LINK_TX_TASK owner, notified of the ACK
+    rtems_event_set tx_event;
+    rtems_id tx_waiter_tid; // notified when the link is released
+    rtems_event_set tx_waiter_event;
+    rtems_interval tx_claimed; // ticks when claimed by link_tx_claim
     const char *name;
     void *priv;
+    volatile uint32_t cmds_dropped; // received when the command queue was full
+    int cmd_prio; // enum cmd_prio of commands received, or CMD_PRIO_DEFAULT
+    struct cmd_server *cmd_server; // for commands received, or NULL for default
+    struct latency_hist cmd_latency; // of commands received, updated by server
     size_t (*write)(struct link *link, void *buf, size_t sz);
     size_t (*read)(struct link *link, void *buf, size_t sz);
     int (*close)(struct link *link);
@@ -50,7 +75,59 @@ ssize_t link_request(struct link *link,
                      rtems_interval wtimeout_ticks, void *wbuf, size_t wsz,
                      rtems_interval rtimeout_ticks, void *rbuf, size_t rsz,
                      rtems_event_set event_wait);
+/**
+ * Send a message without waiting for the ACK. When the ACK arrives, event_ack
+ * is sent to the calling task and link_send_acked returns true.
+ * Only one message may be in flight per link: call link_send_end, whether the
+ * ACK arrived or the caller gave up on it, before sending again. Until then,
+ * the link stays claimed, so no other sender can take the ACK.
+ * Returns number of bytes written, 0 if another message is in flight (then
+ * event_ack is sent when the link is released, to try again, unless
+ * link_send_cancel is called first), or -1 on send failure.
+ */
+ssize_t link_send_async(struct link *link, void *buf, size_t sz,
+                        rtems_event_set event_ack);
+/**
+ * Whether the message sent with link_send_async was ACKed.
+ */
+bool link_send_acked(struct link *link);
+/**
+ * Stop tracking the message sent with link_send_async, releasing the link.
+ */
+void link_send_end(struct link *link);
+/**
+ * Stop waiting for the link after link_send_async returned 0.
+ */
+void link_send_cancel(struct link *link);
+/**
+ * Claim the link for link_send_claimed, e.g., to reply from an interrupt
+ * without the ACK being tracked. Returns false if a message is in flight.
+ * Interrupt-safe, as are link_tx_release and link_send_claimed.
+ */
+bool link_tx_claim(struct link *link);
+/**
+ * Release a claim without sending.
+ */
+void link_tx_release(struct link *link);
+/**
+ * Release a link_tx_claim claim held for at least ticks (non-zero), e.g., when
+ * the ACK for its message was lost, so tasks may send again. An ACK that
+ * arrives later is taken for the next message's.
+ * Returns whether a claim was released.
+ */
+bool link_tx_release_stale(struct link *link, rtems_interval ticks);
+/**
+ * Send a message on a claimed link. The claim is released when the remote ACKs,
+ * or right away on send failure.
+ * Returns 0 on send failure, or number of bytes written.
+ */
+size_t link_send_claimed(struct link *link, void *buf, size_t sz);
 int link_disconnect(struct link *link);
+/**
+ * Set the server for commands received on the link, or NULL for the default
+ * (see cmd_server_set_default). Set before the remote may send commands.
+ */
+void link_set_cmd_server(struct link *link, struct cmd_server *server);
 
 /*
  * These functions are for link implementations
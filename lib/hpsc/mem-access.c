@@ -0,0 +1,282 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+
+#include "command.h"
+#include "hpsc-msg.h"
+#include "mem-access.h"
+
+struct mem_access_region {
+    uintptr_t addr;
+    size_t size;
+    unsigned perms;
+};
+
+struct mem_access_copier {
+    mem_access_copy_t copy;
+    void *arg;
+    size_t min_sz;
+};
+
+static struct mem_access_region regions[MEM_ACCESS_REGIONS_MAX];
+static size_t num_regions = 0;
+static struct mem_access_copier copier = { 0 };
+static rtems_mutex mtx = RTEMS_MUTEX_INITIALIZER("Mem Access");
+
+#define MEM_ACCESS_COPY_PART_SIZE 0x10000
+
+#define IS_ALIGNED(p) (((uintptr_t)(const volatile void *)(p) % \
+                        sizeof(uint32_t)) == 0)
+
+// regions may be device memory, so don't let the compiler pick access sizes
+static void vmem_vcpy(volatile void *dest, const volatile void *src, size_t n)
+{
+    volatile uint32_t *wd = dest;
+    const volatile uint32_t *ws = src;
+    volatile uint8_t *bd;
+    const volatile uint8_t *bs;
+    if (IS_ALIGNED(dest) && IS_ALIGNED(src))
+        for (; n >= sizeof(*wd); n -= sizeof(*wd))
+            *wd++ = *ws++;
+    for (bd = (volatile uint8_t *) wd, bs = (const volatile uint8_t *) ws;
+         n > 0; n--)
+        *bd++ = *bs++;
+}
+
+// caller must hold mtx
+static bool mem_access_allowed(uintptr_t addr, size_t len, unsigned perms)
+{
+    size_t i;
+    for (i = 0; i < num_regions; i++) {
+        if ((regions[i].perms & perms) == perms &&
+            addr >= regions[i].addr && len <= regions[i].size &&
+            addr - regions[i].addr <= regions[i].size - len)
+            return true;
+    }
+    return false;
+}
+
+// Validate the requested segments and coalesce contiguous ones into segs.
+// caller must hold mtx
+static enum hpsc_msg_mem_status
+mem_access_segs(const struct hpsc_msg_mem_seg *req, uint32_t nsegs,
+                unsigned perms, struct hpsc_msg_mem_seg *segs, size_t *n,
+                uint32_t *total)
+{
+    uint32_t addr;
+    uint32_t len;
+    uint32_t i;
+    *n = 0;
+    *total = 0;
+    if (!nsegs || nsegs > HPSC_MSG_MEM_SEGS_MAX)
+        return MEM_STATUS_INVALID;
+    for (i = 0; i < nsegs; i++) {
+        addr = req[i].addr;
+        len = req[i].len;
+        if (!len || len > UINT32_MAX - addr || len > UINT32_MAX - *total)
+            return MEM_STATUS_INVALID;
+        if (!mem_access_allowed(addr, len, perms))
+            return MEM_STATUS_DENIED;
+        *total += len;
+        if (*n && segs[*n - 1].addr + segs[*n - 1].len == addr) {
+            segs[*n - 1].len += len;
+        } else {
+            segs[*n].addr = addr;
+            segs[*n].len = len;
+            (*n)++;
+        }
+    }
+    return MEM_STATUS_OK;
+}
+
+// Large copies are split, with the worker handling the request checking in
+// between parts, so it isn't taken for stuck.
+static void mem_access_copy(const struct mem_access_copier *c,
+                            volatile void *dest, const volatile void *src,
+                            size_t sz)
+{
+    volatile uint8_t *d = dest;
+    const volatile uint8_t *s = src;
+    size_t part;
+    while (sz) {
+        part = sz < MEM_ACCESS_COPY_PART_SIZE ? sz : MEM_ACCESS_COPY_PART_SIZE;
+        if (!c->copy || part < c->min_sz ||
+            c->copy((void *) d, (const void *) s, part, c->arg))
+            vmem_vcpy(d, s, part);
+        d += part;
+        s += part;
+        sz -= part;
+        cmd_check_in();
+    }
+}
+
+rtems_status_code mem_access_allow(uintptr_t addr, size_t size,
+                                   unsigned perms)
+{
+    rtems_status_code sc = RTEMS_SUCCESSFUL;
+    if (!size || size - 1 > UINTPTR_MAX - addr ||
+        !perms || (perms & ~(MEM_ACCESS_READ | MEM_ACCESS_WRITE)))
+        return RTEMS_INVALID_NUMBER;
+    rtems_mutex_lock(&mtx);
+    if (num_regions == MEM_ACCESS_REGIONS_MAX) {
+        sc = RTEMS_TOO_MANY;
+    } else {
+        regions[num_regions].addr = addr;
+        regions[num_regions].size = size;
+        regions[num_regions].perms = perms;
+        num_regions++;
+    }
+    rtems_mutex_unlock(&mtx);
+    return sc;
+}
+
+rtems_status_code mem_access_revoke(uintptr_t addr, size_t size)
+{
+    rtems_status_code sc = RTEMS_INVALID_ADDRESS;
+    size_t i;
+    rtems_mutex_lock(&mtx);
+    for (i = 0; i < num_regions; i++) {
+        if (regions[i].addr == addr && regions[i].size == size) {
+            regions[i] = regions[--num_regions];
+            sc = RTEMS_SUCCESSFUL;
+            break;
+        }
+    }
+    rtems_mutex_unlock(&mtx);
+    return sc;
+}
+
+bool mem_access_check(uintptr_t addr, size_t len, unsigned perms)
+{
+    bool rc;
+    rtems_mutex_lock(&mtx);
+    rc = mem_access_allowed(addr, len, perms);
+    rtems_mutex_unlock(&mtx);
+    return rc;
+}
+
+void mem_access_set_bulk_copy(mem_access_copy_t copy, void *arg,
+                              size_t min_sz)
+{
+    rtems_mutex_lock(&mtx);
+    copier.copy = copy;
+    copier.arg = arg;
+    copier.min_sz = min_sz;
+    rtems_mutex_unlock(&mtx);
+}
+
+void mem_access_get_bulk_copy(mem_access_copy_t *copy, void **arg,
+                              size_t *min_sz)
+{
+    assert(copy);
+    assert(arg);
+    assert(min_sz);
+    rtems_mutex_lock(&mtx);
+    *copy = copier.copy;
+    *arg = copier.arg;
+    *min_sz = copier.min_sz;
+    rtems_mutex_unlock(&mtx);
+}
+
+ssize_t mem_access_read_addr(const void *msg, void *reply, size_t reply_sz)
+{
+    const struct hpsc_msg_read_addr_payload *req =
+        hpsc_msg_read_addr_decode(msg);
+    struct hpsc_msg_read_value_payload *rep;
+    struct hpsc_msg_mem_seg segs[HPSC_MSG_MEM_SEGS_MAX];
+    struct mem_access_copier c;
+    uint32_t buf;
+    uint32_t total;
+    size_t n;
+    size_t i;
+    if (!req || reply_sz != HPSC_MSG_SIZE)
+        return -1;
+    rep = hpsc_msg_read_value_encode(reply);
+    rep->id = READ_ADDR;
+    rep->handle = 0;
+    rep->offset = 0;
+    rep->len = 0;
+    buf = req->buf;
+    rtems_mutex_lock(&mtx);
+    c = copier;
+    rep->status = mem_access_segs(req->segs, req->nsegs, MEM_ACCESS_READ, segs,
+                                  &n, &total);
+    if (rep->status == MEM_STATUS_OK) {
+        if (!buf && total > sizeof(rep->data))
+            rep->status = MEM_STATUS_INVALID;
+        else if (buf && !mem_access_allowed(buf, total, MEM_ACCESS_WRITE))
+            rep->status = MEM_STATUS_DENIED;
+    }
+    rtems_mutex_unlock(&mtx);
+    if (rep->status != MEM_STATUS_OK) {
+        printf("mem-access: READ_ADDR: rejected: %u\n", rep->status);
+        return reply_sz;
+    }
+    for (i = 0; i < n; i++) {
+        if (buf)
+            mem_access_copy(&c, (volatile void *)(uintptr_t) (buf + rep->len),
+                            (const volatile void *)(uintptr_t) segs[i].addr,
+                            segs[i].len);
+        else
+            vmem_vcpy(&rep->data[rep->len],
+                      (const volatile void *)(uintptr_t) segs[i].addr,
+                      segs[i].len);
+        rep->len += segs[i].len;
+    }
+    return reply_sz;
+}
+
+ssize_t mem_access_write_addr(const void *msg, void *reply, size_t reply_sz)
+{
+    const struct hpsc_msg_write_addr_payload *req =
+        hpsc_msg_write_addr_decode(msg);
+    struct hpsc_msg_write_status_payload *rep;
+    struct hpsc_msg_mem_seg segs[HPSC_MSG_MEM_SEGS_MAX];
+    struct mem_access_copier c;
+    uint32_t buf;
+    uint32_t total;
+    size_t n;
+    size_t i;
+    if (!req || reply_sz != HPSC_MSG_SIZE)
+        return -1;
+    rep = hpsc_msg_write_status_encode(reply);
+    rep->id = WRITE_ADDR;
+    rep->handle = 0;
+    rep->offset = 0;
+    rep->len = 0;
+    buf = req->buf;
+    rtems_mutex_lock(&mtx);
+    c = copier;
+    if (!buf && (req->nsegs != 1 || req->inl.seg.len > sizeof(req->inl.data)))
+        rep->status = MEM_STATUS_INVALID;
+    else
+        rep->status = mem_access_segs(req->segs, req->nsegs, MEM_ACCESS_WRITE,
+                                      segs, &n, &total);
+    if (rep->status == MEM_STATUS_OK && buf &&
+        !mem_access_allowed(buf, total, MEM_ACCESS_READ))
+        rep->status = MEM_STATUS_DENIED;
+    rtems_mutex_unlock(&mtx);
+    if (rep->status != MEM_STATUS_OK) {
+        printf("mem-access: WRITE_ADDR: rejected: %u\n", rep->status);
+        return reply_sz;
+    }
+    if (!buf) {
+        vmem_vcpy((volatile void *)(uintptr_t) segs[0].addr, req->inl.data,
+                  segs[0].len);
+        rep->len = segs[0].len;
+        return reply_sz;
+    }
+    for (i = 0; i < n; i++) {
+        mem_access_copy(&c, (volatile void *)(uintptr_t) segs[i].addr,
+                        (const volatile void *)(uintptr_t) (buf + rep->len),
+                        segs[i].len);
+        rep->len += segs[i].len;
+    }
+    return reply_sz;
+}
@@ -0,0 +1,80 @@
+#ifndef MEM_ACCESS_H
+#define MEM_ACCESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <rtems.h>
+
+// Memory access service: serves READ_ADDR and WRITE_ADDR requests, each with a
+// vector of (address, length) segments (see hpsc-msg.h).
+// Segments are checked against an allowlist of regions registered by the app.
+// Segments that are contiguous in request order are coalesced, so a remote
+// that splits a bulk range into several segments still gets one large copy.
+// Large copies may be done by a bulk copier (e.g., DMA) set by the app;
+// otherwise the CPU copies, using word accesses where aligned, and without
+// cache maintenance.
+// Allowlist functions may _not_ be called from an interrupt context.
+
+#define MEM_ACCESS_REGIONS_MAX 16
+
+#define MEM_ACCESS_READ  0x1
+#define MEM_ACCESS_WRITE 0x2
+
+/**
+ * A bulk copy function, which returns 0 on success, or non-zero if it didn't
+ * copy (e.g., due to alignment constraints) and the CPU should copy instead.
+ * It may be called concurrently, by command handlers on different workers.
+ */
+typedef int (*mem_access_copy_t)(void *dest, const void *src, size_t sz,
+                                 void *arg);
+
+/**
+ * Allow access to a memory region, with MEM_ACCESS_READ and/or
+ * MEM_ACCESS_WRITE permissions.
+ * Each segment must lie entirely within a single allowed region.
+ */
+rtems_status_code mem_access_allow(uintptr_t addr, size_t size,
+                                   unsigned perms);
+
+/**
+ * Revoke access to a region, which must match a previously allowed one.
+ */
+rtems_status_code mem_access_revoke(uintptr_t addr, size_t size);
+
+/**
+ * Check that a range lies entirely within an allowed region with the perms,
+ * e.g., for other services that transfer data through buffers named by remotes.
+ */
+bool mem_access_check(uintptr_t addr, size_t len, unsigned perms);
+
+/**
+ * Set the bulk copier, used for coalesced segments of at least min_sz bytes,
+ * or NULL to always copy with the CPU.
+ */
+void mem_access_set_bulk_copy(mem_access_copy_t copy, void *arg,
+                              size_t min_sz);
+
+/**
+ * Get the bulk copier.
+ */
+void mem_access_get_bulk_copy(mem_access_copy_t *copy, void **arg,
+                              size_t *min_sz);
+
+/**
+ * Serve a READ_ADDR message, writing a READ_VALUE reply.
+ * An invalid or denied request still gets a reply, with an error status.
+ * Returns the reply size, or -1 if the message isn't a READ_ADDR.
+ */
+ssize_t mem_access_read_addr(const void *msg, void *reply, size_t reply_sz);
+
+/**
+ * Serve a WRITE_ADDR message, writing a WRITE_STATUS reply.
+ * An invalid or denied request still gets a reply, with an error status.
+ * Returns the reply size, or -1 if the message isn't a WRITE_ADDR.
+ */
+ssize_t mem_access_write_addr(const void *msg, void *reply, size_t reply_sz);
+
+#endif // MEM_ACCESS_H
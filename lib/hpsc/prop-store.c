@@ -0,0 +1,239 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+
+#include "hpsc-msg.h"
+#include "prop-store.h"
+
+#define PROP_STORE_MASK (PROP_STORE_CAPACITY - 1)
+
+_Static_assert((PROP_STORE_CAPACITY & PROP_STORE_MASK) == 0,
+               "PROP_STORE_CAPACITY must be a power of two");
+
+// A slot is claimed by publishing its id last, and is never freed, so readers
+// that find an id can trust the rest of the slot.
+struct prop_slot {
+    atomic_uint id; // 0 if free
+    atomic_uchar type; // PROP_TYPE_NONE if unregistered
+    uint8_t flags;
+    atomic_uint value;
+};
+
+static struct prop_slot slots[PROP_STORE_CAPACITY];
+static size_t num_slots = 0; // claimed
+static rtems_mutex mtx = RTEMS_MUTEX_INITIALIZER("Prop Store");
+
+// Linear probing from the ID's home slot, stopping at the first free slot.
+// Returns the ID's slot, else NULL and the free slot (if any) in free_slot.
+static struct prop_slot *prop_store_find(uint32_t id,
+                                         struct prop_slot **free_slot)
+{
+    struct prop_slot *slot;
+    unsigned sid;
+    unsigned i;
+    for (i = 0; i < PROP_STORE_CAPACITY; i++) {
+        slot = &slots[(id + i) & PROP_STORE_MASK];
+        sid = atomic_load_explicit(&slot->id, memory_order_acquire);
+        if (sid == id)
+            return slot;
+        if (!sid) {
+            if (free_slot)
+                *free_slot = slot;
+            return NULL;
+        }
+    }
+    if (free_slot)
+        *free_slot = NULL;
+    return NULL;
+}
+
+static bool prop_store_valid(enum hpsc_msg_prop_type type, uint32_t value)
+{
+    switch (type) {
+        case PROP_TYPE_U32:
+        case PROP_TYPE_I32:
+            return true;
+        case PROP_TYPE_BOOL:
+            return value <= 1;
+        default:
+            return false;
+    }
+}
+
+static void prop_store_fill(struct prop_slot *slot,
+                            enum hpsc_msg_prop_type type, unsigned flags,
+                            uint32_t value)
+{
+    atomic_store_explicit(&slot->value, value, memory_order_relaxed);
+    slot->flags = flags;
+    atomic_store_explicit(&slot->type, type, memory_order_release);
+}
+
+rtems_status_code prop_store_register(uint32_t id,
+                                      enum hpsc_msg_prop_type type,
+                                      unsigned flags, uint32_t value)
+{
+    struct prop_slot *slot;
+    struct prop_slot *free_slot;
+    rtems_status_code sc = RTEMS_SUCCESSFUL;
+    if (!id || !prop_store_valid(type, value) ||
+        (flags & ~PROP_STORE_WRITABLE))
+        return RTEMS_INVALID_NUMBER;
+    rtems_mutex_lock(&mtx);
+    slot = prop_store_find(id, &free_slot);
+    if (slot) {
+        if (atomic_load_explicit(&slot->type, memory_order_relaxed) !=
+                PROP_TYPE_NONE)
+            sc = RTEMS_RESOURCE_IN_USE;
+        else
+            prop_store_fill(slot, type, flags, value);
+    } else if (num_slots == PROP_STORE_MAX) {
+        sc = RTEMS_TOO_MANY;
+    } else {
+        // PROP_STORE_MAX < PROP_STORE_CAPACITY, so there's always a free slot
+        prop_store_fill(free_slot, type, flags, value);
+        atomic_store_explicit(&free_slot->id, id, memory_order_release);
+        num_slots++;
+    }
+    rtems_mutex_unlock(&mtx);
+    return sc;
+}
+
+rtems_status_code prop_store_unregister(uint32_t id)
+{
+    struct prop_slot *slot;
+    rtems_status_code sc = RTEMS_INVALID_ID;
+    rtems_mutex_lock(&mtx);
+    slot = prop_store_find(id, NULL);
+    if (slot && atomic_load_explicit(&slot->type, memory_order_relaxed) !=
+            PROP_TYPE_NONE) {
+        atomic_store_explicit(&slot->type, PROP_TYPE_NONE,
+                              memory_order_release);
+        sc = RTEMS_SUCCESSFUL;
+    }
+    rtems_mutex_unlock(&mtx);
+    return sc;
+}
+
+enum hpsc_msg_prop_type prop_store_get(uint32_t id, uint32_t *value)
+{
+    struct prop_slot *slot = prop_store_find(id, NULL);
+    enum hpsc_msg_prop_type type;
+    if (!slot)
+        return PROP_TYPE_NONE;
+    type = atomic_load_explicit(&slot->type, memory_order_acquire);
+    if (type != PROP_TYPE_NONE && value)
+        *value = atomic_load_explicit(&slot->value, memory_order_acquire);
+    return type;
+}
+
+rtems_status_code prop_store_set(uint32_t id, uint32_t value)
+{
+    struct prop_slot *slot = prop_store_find(id, NULL);
+    enum hpsc_msg_prop_type type;
+    if (!slot)
+        return RTEMS_INVALID_ID;
+    type = atomic_load_explicit(&slot->type, memory_order_acquire);
+    if (type == PROP_TYPE_NONE)
+        return RTEMS_INVALID_ID;
+    if (!prop_store_valid(type, value))
+        return RTEMS_INVALID_NUMBER;
+    atomic_store_explicit(&slot->value, value, memory_order_release);
+    return RTEMS_SUCCESSFUL;
+}
+
+rtems_status_code prop_store_add(uint32_t id, uint32_t delta)
+{
+    struct prop_slot *slot = prop_store_find(id, NULL);
+    enum hpsc_msg_prop_type type;
+    if (!slot)
+        return RTEMS_INVALID_ID;
+    type = atomic_load_explicit(&slot->type, memory_order_acquire);
+    if (type == PROP_TYPE_NONE)
+        return RTEMS_INVALID_ID;
+    if (type != PROP_TYPE_U32 && type != PROP_TYPE_I32)
+        return RTEMS_INVALID_NUMBER;
+    atomic_fetch_add_explicit(&slot->value, delta, memory_order_relaxed);
+    return RTEMS_SUCCESSFUL;
+}
+
+ssize_t prop_store_read_prop(const void *msg, void *reply, size_t reply_sz)
+{
+    const struct hpsc_msg_read_prop_payload *req =
+        hpsc_msg_read_prop_decode(msg);
+    struct hpsc_msg_read_value_payload *rep;
+    uint32_t value;
+    unsigned i;
+    if (!req || reply_sz != HPSC_MSG_SIZE)
+        return -1;
+    rep = hpsc_msg_read_value_encode(reply);
+    rep->id = READ_PROP;
+    rep->status = PROP_STATUS_OK;
+    rep->handle = 0;
+    rep->offset = 0;
+    rep->len = 0;
+    memset(&rep->props, 0, sizeof(rep->props));
+    if (!req->count || req->count > HPSC_MSG_PROP_READS_MAX) {
+        rep->status = PROP_STATUS_INVALID;
+        return reply_sz;
+    }
+    // all are read, so one missing property doesn't hide the others
+    for (i = 0; i < req->count; i++) {
+        value = 0;
+        rep->props.types[i] = prop_store_get(req->ids[i], &value);
+        rep->props.values[i] = value;
+        if (rep->props.types[i] == PROP_TYPE_NONE)
+            rep->status = PROP_STATUS_NOT_FOUND;
+    }
+    rep->len = req->count;
+    return reply_sz;
+}
+
+ssize_t prop_store_write_prop(const void *msg, void *reply, size_t reply_sz)
+{
+    const struct hpsc_msg_write_prop_payload *req =
+        hpsc_msg_write_prop_decode(msg);
+    struct hpsc_msg_write_status_payload *rep;
+    struct prop_slot *slot;
+    enum hpsc_msg_prop_type type;
+    uint32_t value;
+    unsigned i;
+    if (!req || reply_sz != HPSC_MSG_SIZE)
+        return -1;
+    rep = hpsc_msg_write_status_encode(reply);
+    rep->id = WRITE_PROP;
+    rep->status = PROP_STATUS_OK;
+    rep->handle = 0;
+    rep->offset = 0;
+    rep->len = 0;
+    if (!req->count || req->count > HPSC_MSG_PROP_WRITES_MAX) {
+        rep->status = PROP_STATUS_INVALID;
+        return reply_sz;
+    }
+    for (i = 0; i < req->count; i++) {
+        slot = prop_store_find(req->props[i].id, NULL);
+        type = slot ? atomic_load_explicit(&slot->type, memory_order_acquire) :
+                      PROP_TYPE_NONE;
+        value = req->props[i].value;
+        if (type == PROP_TYPE_NONE) {
+            rep->status = PROP_STATUS_NOT_FOUND;
+            break;
+        }
+        if (type != req->types[i] || !prop_store_valid(type, value)) {
+            rep->status = PROP_STATUS_INVALID;
+            break;
+        }
+        if (!(slot->flags & PROP_STORE_WRITABLE)) {
+            rep->status = PROP_STATUS_DENIED;
+            break;
+        }
+        atomic_store_explicit(&slot->value, value, memory_order_release);
+        rep->len++;
+    }
+    return reply_sz;
+}
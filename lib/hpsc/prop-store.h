@@ -0,0 +1,75 @@
+#ifndef PROP_STORE_H
+#define PROP_STORE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <rtems.h>
+
+#include "hpsc-msg.h"
+
+// Property store: typed 32-bit values (e.g., configuration and counters) keyed
+// by hashed property IDs (see hpsc_msg_prop_id), served to remotes in batches
+// by READ_PROP and WRITE_PROP requests (see hpsc-msg.h).
+// The store is a fixed-capacity open-addressing hash table. Slots are never
+// moved or freed once claimed, so lookups take no locks: getting, setting and
+// serving requests are safe from interrupt contexts, and a value is never seen
+// torn. Only registering and unregistering take a lock.
+// Registering and unregistering may _not_ be done from an interrupt context.
+
+#define PROP_STORE_CAPACITY 64 // slots, a power of two
+// keep the table sparse, so probe sequences stay short
+#define PROP_STORE_MAX (PROP_STORE_CAPACITY * 3 / 4)
+
+// prop_store_register flags
+#define PROP_STORE_WRITABLE 0x1 // by remotes; local sets are always allowed
+
+/**
+ * Register a property with its initial value.
+ * Returns RTEMS_RESOURCE_IN_USE if the ID is already registered, or
+ * RTEMS_TOO_MANY if PROP_STORE_MAX properties are.
+ */
+rtems_status_code prop_store_register(uint32_t id,
+                                      enum hpsc_msg_prop_type type,
+                                      unsigned flags, uint32_t value);
+
+/**
+ * Unregister a property. Its slot is kept for re-registering the same ID, so
+ * doesn't count against PROP_STORE_MAX again.
+ * A reader racing the re-registration of the ID with another type may see the
+ * new type with the old value, so this is meant for teardown.
+ */
+rtems_status_code prop_store_unregister(uint32_t id);
+
+/**
+ * Get a property's value. Returns its type, or PROP_TYPE_NONE if not found.
+ */
+enum hpsc_msg_prop_type prop_store_get(uint32_t id, uint32_t *value);
+
+/**
+ * Set a property's value, which must be valid for its type.
+ */
+rtems_status_code prop_store_set(uint32_t id, uint32_t value);
+
+/**
+ * Atomically add to a PROP_TYPE_U32 or PROP_TYPE_I32 property, e.g., a
+ * counter. Wraps on overflow.
+ */
+rtems_status_code prop_store_add(uint32_t id, uint32_t delta);
+
+/**
+ * Serve a READ_PROP message, writing a READ_VALUE reply.
+ * An invalid request still gets a reply, with an error status.
+ * Returns the reply size, or -1 if the message isn't a READ_PROP.
+ */
+ssize_t prop_store_read_prop(const void *msg, void *reply, size_t reply_sz);
+
+/**
+ * Serve a WRITE_PROP message, writing a WRITE_STATUS reply.
+ * An invalid or denied request still gets a reply, with an error status.
+ * Returns the reply size, or -1 if the message isn't a WRITE_PROP.
+ */
+ssize_t prop_store_write_prop(const void *msg, void *reply, size_t reply_sz);
+
+#endif // PROP_STORE_H
@@ -0,0 +1,387 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/bspIo.h>
+
+#include "shmem-arena.h"
+
+#define ORDER_MIN 2 // buffers are word-aligned
+#define ORDER_MAX 31
+#define OFFSET_NONE 0 // the header is always at offset 0
+
+#define ORDER_SIZE(o) ((uint32_t) 1 << (o))
+
+struct shmem_arena_pool {
+    uint32_t count;
+    uint32_t start;
+    uint32_t end;
+    unsigned order;
+    // offsets of free buffers, a stack in local memory, since remotes may
+    // still write (by mistake) to buffers they returned
+    uint32_t *free;
+    uint32_t num_free;
+    size_t first_bit; // of its buffers in the arena's allocated bitmap
+};
+
+struct shmem_arena {
+    volatile struct hpsc_shmem_arena_hdr *hdr;
+    uintptr_t base;
+    rtems_interrupt_lock lock;
+    // a bit per buffer, set while allocated, so a remote can't return a buffer
+    // that isn't out (e.g., twice) and corrupt a free list
+    uint32_t *allocated;
+    uint32_t *free; // backs the pools' free stacks
+    // sorted by descending order
+    struct shmem_arena_pool *pools;
+    size_t num_pools;
+    size_t num_ports; // not trusted from the header, which remotes may write
+    // index of the smallest pool that fits a buffer of each order, or -1
+    int pool_by_order[ORDER_MAX + 1];
+};
+
+#define HDR_SIZE(num_ports) \
+    (sizeof(struct hpsc_shmem_arena_hdr) + \
+     (num_ports) * sizeof(struct hpsc_shmem_arena_port))
+
+static unsigned order_of(size_t sz)
+{
+    if (sz <= ORDER_SIZE(ORDER_MIN))
+        return ORDER_MIN;
+    return 32 - __builtin_clz(sz - 1);
+}
+
+static struct shmem_arena_pool *pool_of(struct shmem_arena *a, uint32_t offset)
+{
+    size_t i;
+    for (i = 0; i < a->num_pools; i++) {
+        if (offset >= a->pools[i].start && offset < a->pools[i].end)
+            return &a->pools[i];
+    }
+    return NULL;
+}
+
+static size_t buf_bit(struct shmem_arena_pool *pool, uint32_t offset)
+{
+    return pool->first_bit + ((offset - pool->start) >> pool->order);
+}
+
+// Whether offset is the start of an allocated buffer in the pool
+static bool buf_allocated_unsafe(struct shmem_arena *a,
+                                 struct shmem_arena_pool *pool,
+                                 uint32_t offset)
+{
+    size_t bit;
+    if ((offset - pool->start) & (ORDER_SIZE(pool->order) - 1))
+        return false;
+    bit = buf_bit(pool, offset);
+    return a->allocated[bit / 32] & ((uint32_t) 1 << (bit % 32));
+}
+
+static void pool_push_unsafe(struct shmem_arena *a,
+                             struct shmem_arena_pool *pool, uint32_t offset)
+{
+    size_t bit;
+    assert(!((offset - pool->start) & (ORDER_SIZE(pool->order) - 1)));
+    bit = buf_bit(pool, offset);
+    a->allocated[bit / 32] &= ~((uint32_t) 1 << (bit % 32));
+    assert(pool->num_free < pool->count);
+    pool->free[pool->num_free++] = offset;
+}
+
+static uint32_t pool_pop_unsafe(struct shmem_arena *a,
+                                struct shmem_arena_pool *pool)
+{
+    uint32_t offset;
+    size_t bit;
+    if (!pool->num_free)
+        return OFFSET_NONE;
+    offset = pool->free[--pool->num_free];
+    bit = buf_bit(pool, offset);
+    a->allocated[bit / 32] |= (uint32_t) 1 << (bit % 32);
+    return offset;
+}
+
+// Offsets that aren't of an allocated buffer (misaligned, or returned twice)
+// are counted in bad. A port whose head is impossibly far ahead is resynced,
+// dropping its slots, and counted in resynced. Reports are left to the caller,
+// so the lock isn't held while printing.
+static size_t reclaim_unsafe(struct shmem_arena *a, size_t *bad,
+                             size_t *resynced)
+{
+    volatile struct hpsc_shmem_arena_port *port;
+    struct shmem_arena_pool *pool;
+    uint32_t head;
+    uint32_t offset;
+    size_t i;
+    size_t n = 0;
+    for (i = 0; i < a->num_ports; i++) {
+        port = &a->hdr->ports[i];
+        head = port->head;
+        if (head - port->tail > HPSC_SHMEM_ARENA_PORT_SLOTS) {
+            port->tail = head;
+            (*resynced)++;
+            continue;
+        }
+        // read offsets only after the remote published them
+        atomic_thread_fence(memory_order_acquire);
+        while (port->tail != head) {
+            offset = port->offsets[port->tail % HPSC_SHMEM_ARENA_PORT_SLOTS];
+            pool = pool_of(a, offset);
+            if (pool && buf_allocated_unsafe(a, pool, offset))
+                pool_push_unsafe(a, pool, offset);
+            else
+                (*bad)++;
+            // let the remote reuse the slot only after we're done with it
+            atomic_thread_fence(memory_order_release);
+            port->tail++;
+            n++;
+        }
+    }
+    return n;
+}
+
+static void reclaim_report(size_t bad, size_t resynced)
+{
+    if (bad)
+        printk("shmem_arena: dropped %zu bad offsets\n", bad);
+    if (resynced)
+        printk("shmem_arena: resynced %zu ports with a bad head\n", resynced);
+}
+
+static int pools_init(struct shmem_arena *a,
+                      const struct shmem_arena_class *classes,
+                      size_t num_classes, size_t size)
+{
+    struct shmem_arena_pool tmp;
+    uint64_t offset;
+    uint32_t buf;
+    size_t bits = 0;
+    size_t i;
+    size_t j;
+    unsigned o;
+
+    for (i = 0; i < num_classes; i++) {
+        assert(classes[i].order >= ORDER_MIN && classes[i].order <= ORDER_MAX);
+        a->pools[i].order = classes[i].order;
+        a->pools[i].count = classes[i].count;
+    }
+    // insertion sort by descending order -- the number of classes is small
+    for (i = 1; i < num_classes; i++) {
+        tmp = a->pools[i];
+        for (j = i; j > 0 && a->pools[j - 1].order < tmp.order; j--)
+            a->pools[j] = a->pools[j - 1];
+        a->pools[j] = tmp;
+    }
+
+    offset = HDR_SIZE(a->num_ports);
+    for (i = 0; i < num_classes; i++) {
+        if (i)
+            assert(a->pools[i].order != a->pools[i - 1].order);
+        // only the first pool needs padding, the rest remain aligned
+        offset = (offset + ORDER_SIZE(a->pools[i].order) - 1) &
+                 ~((uint64_t) ORDER_SIZE(a->pools[i].order) - 1);
+        a->pools[i].start = offset;
+        offset += (uint64_t) a->pools[i].count << a->pools[i].order;
+        if (offset > size)
+            return -1;
+        a->pools[i].end = offset;
+        a->pools[i].num_free = 0;
+        a->pools[i].first_bit = bits;
+        bits += a->pools[i].count;
+    }
+
+    a->allocated = calloc((bits + 31) / 32, sizeof(*a->allocated));
+    a->free = malloc(bits * sizeof(*a->free));
+    if (!a->allocated || (bits && !a->free))
+        return -1;
+    for (i = 0; i < num_classes; i++) {
+        a->pools[i].free = &a->free[a->pools[i].first_bit];
+        // push in reverse, so buffers are allocated in address order
+        for (buf = a->pools[i].end; buf > a->pools[i].start; )
+            pool_push_unsafe(a, &a->pools[i],
+                             buf -= ORDER_SIZE(a->pools[i].order));
+    }
+
+    // pools are sorted largest first, so search backwards for the best fit
+    for (o = 0; o <= ORDER_MAX; o++) {
+        a->pool_by_order[o] = -1;
+        for (i = num_classes; i > 0; i--) {
+            if (a->pools[i - 1].order >= o) {
+                a->pool_by_order[o] = i - 1;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+struct shmem_arena *shmem_arena_create(
+    uintptr_t addr,
+    size_t size,
+    const struct shmem_arena_class *classes,
+    size_t num_classes,
+    size_t num_ports
+)
+{
+    struct shmem_arena *a;
+    size_t i;
+    assert(addr);
+    assert(!(addr % sizeof(uint32_t)));
+    assert(classes);
+    assert(num_classes);
+
+    printk("shmem_arena: create\n");
+    printk("\taddr      = 0x%"PRIxPTR"\n", addr);
+    printk("\tsize      = 0x%zx\n", size);
+    printk("\tnum_ports = %zu\n", num_ports);
+    if (HDR_SIZE(num_ports) > size)
+        return NULL;
+    a = malloc(sizeof(*a));
+    if (!a)
+        return NULL;
+    a->pools = malloc(num_classes * sizeof(*a->pools));
+    if (!a->pools)
+        goto free_a;
+    a->num_pools = num_classes;
+    a->num_ports = num_ports;
+    a->allocated = NULL;
+    a->free = NULL;
+    a->base = addr;
+    a->hdr = (volatile struct hpsc_shmem_arena_hdr *) addr;
+    a->hdr->magic = 0; // not valid until initialized
+    a->hdr->size = size;
+    a->hdr->num_ports = num_ports;
+    a->hdr->reserved = 0;
+    for (i = 0; i < num_ports; i++) {
+        a->hdr->ports[i].head = 0;
+        a->hdr->ports[i].tail = 0;
+    }
+    if (pools_init(a, classes, num_classes, size)) {
+        printk("shmem_arena: classes don't fit in region or no memory\n");
+        goto free_pools;
+    }
+    rtems_interrupt_lock_initialize(&a->lock, "Shmem Arena");
+    atomic_thread_fence(memory_order_release);
+    a->hdr->magic = HPSC_SHMEM_ARENA_MAGIC;
+    return a;
+
+free_pools:
+    free(a->free);
+    free(a->allocated);
+    free(a->pools);
+free_a:
+    free(a);
+    return NULL;
+}
+
+void shmem_arena_destroy(struct shmem_arena *a)
+{
+    assert(a);
+    a->hdr->magic = 0;
+    rtems_interrupt_lock_destroy(&a->lock);
+    free(a->free);
+    free(a->allocated);
+    free(a->pools);
+    free(a);
+}
+
+void *shmem_arena_alloc(struct shmem_arena *a, size_t sz)
+{
+    rtems_interrupt_lock_context lock_context;
+    uint32_t offset = OFFSET_NONE;
+    unsigned order;
+    int i;
+    assert(a);
+    order = order_of(sz);
+    if (order > ORDER_MAX || a->pool_by_order[order] < 0)
+        return NULL;
+    rtems_interrupt_lock_acquire(&a->lock, &lock_context);
+    for (i = a->pool_by_order[order]; i >= 0; i--) {
+        offset = pool_pop_unsafe(a, &a->pools[i]);
+        if (offset != OFFSET_NONE)
+            break;
+    }
+    rtems_interrupt_lock_release(&a->lock, &lock_context);
+    return offset == OFFSET_NONE ? NULL : (void *)(a->base + offset);
+}
+
+void shmem_arena_free(struct shmem_arena *a, void *buf)
+{
+    rtems_interrupt_lock_context lock_context;
+    struct shmem_arena_pool *pool;
+    uint32_t offset;
+    assert(a);
+    assert(buf);
+    offset = shmem_arena_to_offset(a, buf);
+    pool = pool_of(a, offset);
+    assert(pool);
+    rtems_interrupt_lock_acquire(&a->lock, &lock_context);
+    assert(buf_allocated_unsafe(a, pool, offset));
+    pool_push_unsafe(a, pool, offset);
+    rtems_interrupt_lock_release(&a->lock, &lock_context);
+}
+
+size_t shmem_arena_reclaim(struct shmem_arena *a)
+{
+    rtems_interrupt_lock_context lock_context;
+    size_t bad = 0;
+    size_t resynced = 0;
+    size_t n;
+    assert(a);
+    rtems_interrupt_lock_acquire(&a->lock, &lock_context);
+    n = reclaim_unsafe(a, &bad, &resynced);
+    rtems_interrupt_lock_release(&a->lock, &lock_context);
+    reclaim_report(bad, resynced);
+    return n;
+}
+
+size_t shmem_arena_buf_size(struct shmem_arena *a, const void *buf)
+{
+    struct shmem_arena_pool *pool;
+    assert(a);
+    pool = pool_of(a, shmem_arena_to_offset(a, buf));
+    assert(pool);
+    return ORDER_SIZE(pool->order);
+}
+
+uint32_t shmem_arena_to_offset(struct shmem_arena *a, const void *buf)
+{
+    assert(a);
+    assert((uintptr_t) buf > a->base);
+    assert((uintptr_t) buf - a->base < a->hdr->size);
+    return (uintptr_t) buf - a->base;
+}
+
+void *shmem_arena_from_offset(struct shmem_arena *a, uint32_t offset)
+{
+    assert(a);
+    assert(offset != OFFSET_NONE && offset < a->hdr->size);
+    return (void *)(a->base + offset);
+}
+
+int shmem_arena_return(uintptr_t addr, unsigned port, uint32_t offset)
+{
+    volatile struct hpsc_shmem_arena_hdr *hdr =
+        (volatile struct hpsc_shmem_arena_hdr *) addr;
+    volatile struct hpsc_shmem_arena_port *p;
+    uint32_t head;
+    assert(addr);
+    if (hdr->magic != HPSC_SHMEM_ARENA_MAGIC || port >= hdr->num_ports)
+        return -1;
+    p = &hdr->ports[port];
+    head = p->head;
+    if (head - p->tail >= HPSC_SHMEM_ARENA_PORT_SLOTS)
+        return 1; // full
+    // don't overwrite the slot until the owner is done with it
+    atomic_thread_fence(memory_order_acquire);
+    p->offsets[head % HPSC_SHMEM_ARENA_PORT_SLOTS] = offset;
+    // publish the offset before the head
+    atomic_thread_fence(memory_order_release);
+    p->head = head + 1;
+    return 0;
+}
@@ -0,0 +1,108 @@
+#ifndef SHMEM_ARENA_H
+#define SHMEM_ARENA_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// All subsystems must understand these structures and their protocol.
+// The arena owner allocates and frees buffers; remotes return buffers they were
+// given by writing the buffer's offset (relative to the region base, since
+// subsystems may map the region at different addresses) to a return port.
+// Each port is a single-producer/single-consumer ring: only the remote writes
+// head and the offsets, and only the owner writes tail.
+#define HPSC_SHMEM_ARENA_MAGIC 0x41524e41 // "ARNA"
+#define HPSC_SHMEM_ARENA_PORT_SLOTS 32
+struct hpsc_shmem_arena_port {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t offsets[HPSC_SHMEM_ARENA_PORT_SLOTS];
+};
+
+struct hpsc_shmem_arena_hdr {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t num_ports;
+    uint32_t reserved;
+    struct hpsc_shmem_arena_port ports[];
+};
+
+/**
+ * A class of equally-sized buffers, all aligned to their size.
+ */
+struct shmem_arena_class {
+    unsigned order; // buffer size is (1 << order), at least 4 bytes
+    size_t count;
+};
+
+struct shmem_arena;
+
+/**
+ * Create an arena in the shared memory region at addr, which is overwritten.
+ * Classes must have unique orders, and are laid out in the region largest
+ * first so that each buffer is aligned to its size.
+ * The region should be aligned to the largest buffer size.
+ * May not be called from an interrupt context.
+ */
+struct shmem_arena *shmem_arena_create(
+    uintptr_t addr,
+    size_t size,
+    const struct shmem_arena_class *classes,
+    size_t num_classes,
+    size_t num_ports
+);
+
+/**
+ * Destroy an arena. Outstanding buffers are simply forgotten.
+ * May not be called from an interrupt context.
+ */
+void shmem_arena_destroy(struct shmem_arena *a);
+
+/**
+ * Allocate a buffer of at least sz bytes from the smallest class that has one,
+ * in O(1) time. Buffers returned by remotes are allocated again only once
+ * reclaimed with shmem_arena_reclaim.
+ * May be called from an interrupt context.
+ * Returns NULL if no buffer is available.
+ */
+void *shmem_arena_alloc(struct shmem_arena *a, size_t sz);
+
+/**
+ * Free a buffer allocated from the arena.
+ * May be called from an interrupt context.
+ */
+void shmem_arena_free(struct shmem_arena *a, void *buf);
+
+/**
+ * Reclaim all buffers returned by remotes, e.g., periodically or when an
+ * allocation fails. Takes time linear in the number of ports.
+ * Offsets that aren't of an allocated buffer (e.g., misaligned, or returned
+ * twice) are dropped, as are the slots of a port whose head is corrupt (more
+ * than a port's slots ahead).
+ * Returns the number of offsets consumed from the ports.
+ */
+size_t shmem_arena_reclaim(struct shmem_arena *a);
+
+/**
+ * Get the size of a buffer allocated from the arena.
+ */
+size_t shmem_arena_buf_size(struct shmem_arena *a, const void *buf);
+
+/**
+ * Translate a buffer to its offset in the region, to share with remotes.
+ */
+uint32_t shmem_arena_to_offset(struct shmem_arena *a, const void *buf);
+
+/**
+ * Translate an offset in the region to a buffer.
+ */
+void *shmem_arena_from_offset(struct shmem_arena *a, uint32_t offset);
+
+/**
+ * Return a buffer to the arena owner through a port, as a remote would.
+ * The region address is the remote's mapping of the arena region.
+ * Each port may only be used by one remote (or task) at a time.
+ * Returns 0 on success, or a non-zero value if the port is full or invalid.
+ */
+int shmem_arena_return(uintptr_t addr, unsigned port, uint32_t offset);
+
+#endif // SHMEM_ARENA_H
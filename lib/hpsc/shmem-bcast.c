@@ -0,0 +1,199 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/bspIo.h>
+
+#include "shmem-bcast.h"
+
+#define SLOTS_MIN 2
+
+struct shmem_bcast {
+    volatile struct hpsc_shmem_bcast_hdr *hdr;
+    struct doorbell *db;
+    rtems_interrupt_lock lock;
+    uint32_t mask;
+    uint32_t seq;
+};
+
+struct shmem_bcast_reader {
+    volatile struct hpsc_shmem_bcast_hdr *hdr;
+    uint32_t mask;
+    uint32_t cursor; // the next sequence number to read
+};
+
+static void vmem_cpy(volatile uint8_t *dest, const uint8_t *src, size_t sz)
+{
+    while (sz--)
+        *dest++ = *src++;
+}
+
+static void vmem_set(volatile uint8_t *dest, uint8_t val, size_t sz)
+{
+    while (sz--)
+        *dest++ = val;
+}
+
+static void mem_vcpy(uint8_t *dest, const volatile uint8_t *src, size_t sz)
+{
+    while (sz--)
+        *dest++ = *src++;
+}
+
+struct shmem_bcast *shmem_bcast_create(uintptr_t addr, size_t size,
+                                       struct doorbell *db)
+{
+    struct shmem_bcast *b;
+    size_t num_slots;
+    size_t i;
+    assert(addr);
+    assert(!(addr % sizeof(uint32_t)));
+
+    if (size < sizeof(struct hpsc_shmem_bcast_hdr))
+        return NULL;
+    num_slots = (size - sizeof(struct hpsc_shmem_bcast_hdr)) /
+                sizeof(struct hpsc_shmem_bcast_slot);
+    if (num_slots > UINT32_MAX)
+        num_slots = UINT32_MAX;
+    if (num_slots < SLOTS_MIN)
+        return NULL;
+    // round down to a power of two
+    while (num_slots & (num_slots - 1))
+        num_slots &= num_slots - 1;
+    printk("shmem_bcast: create\n");
+    printk("\taddr      = 0x%"PRIxPTR"\n", addr);
+    printk("\tnum_slots = %zu\n", num_slots);
+    b = malloc(sizeof(*b));
+    if (!b)
+        return NULL;
+    b->hdr = (volatile struct hpsc_shmem_bcast_hdr *) addr;
+    b->db = db;
+    b->mask = num_slots - 1;
+    b->seq = 0;
+    b->hdr->magic = 0; // not valid until initialized
+    b->hdr->num_slots = num_slots;
+    b->hdr->seq = 0;
+    b->hdr->reserved = 0;
+    for (i = 0; i < num_slots; i++) {
+        b->hdr->slots[i].seq = 0;
+        b->hdr->slots[i].reserved = 0;
+    }
+    rtems_interrupt_lock_initialize(&b->lock, "Shmem Bcast");
+    atomic_thread_fence(memory_order_release);
+    b->hdr->magic = HPSC_SHMEM_BCAST_MAGIC;
+    return b;
+}
+
+void shmem_bcast_destroy(struct shmem_bcast *b)
+{
+    assert(b);
+    b->hdr->magic = 0;
+    if (b->db)
+        doorbell_close(b->db);
+    rtems_interrupt_lock_destroy(&b->lock);
+    free(b);
+}
+
+uint32_t shmem_bcast_publish(struct shmem_bcast *b, void *msg, size_t sz)
+{
+    rtems_interrupt_lock_context lock_context;
+    volatile struct hpsc_shmem_bcast_slot *slot;
+    uint32_t seq;
+    assert(b);
+    assert(msg);
+    assert(sz <= HPSC_MSG_SIZE);
+    rtems_interrupt_lock_acquire(&b->lock, &lock_context);
+    seq = ++b->seq;
+    slot = &b->hdr->slots[(seq - 1) & b->mask];
+    // invalidate the slot for readers before overwriting it
+    slot->seq = seq - 1;
+    atomic_thread_fence(memory_order_release);
+    vmem_cpy(slot->data, msg, sz);
+    if (sz < HPSC_MSG_SIZE)
+        vmem_set(&slot->data[sz], 0, HPSC_MSG_SIZE - sz);
+    atomic_thread_fence(memory_order_release);
+    slot->seq = seq;
+    // readers must find the slot published when they see the head
+    atomic_thread_fence(memory_order_release);
+    b->hdr->seq = seq;
+    rtems_interrupt_lock_release(&b->lock, &lock_context);
+    if (b->db)
+        doorbell_ring(b->db);
+    return seq;
+}
+
+struct shmem_bcast_reader *shmem_bcast_reader_open(uintptr_t addr)
+{
+    volatile struct hpsc_shmem_bcast_hdr *hdr =
+        (volatile struct hpsc_shmem_bcast_hdr *) addr;
+    struct shmem_bcast_reader *r;
+    uint32_t num_slots;
+    assert(addr);
+    if (hdr->magic != HPSC_SHMEM_BCAST_MAGIC)
+        return NULL;
+    atomic_thread_fence(memory_order_acquire);
+    num_slots = hdr->num_slots;
+    if (num_slots < SLOTS_MIN || (num_slots & (num_slots - 1)))
+        return NULL;
+    r = malloc(sizeof(*r));
+    if (!r)
+        return NULL;
+    r->hdr = hdr;
+    r->mask = num_slots - 1;
+    r->cursor = hdr->seq + 1;
+    return r;
+}
+
+void shmem_bcast_reader_close(struct shmem_bcast_reader *r)
+{
+    assert(r);
+    free(r);
+}
+
+size_t shmem_bcast_read(struct shmem_bcast_reader *r, void *msg, size_t sz,
+                        uint32_t *lost)
+{
+    volatile struct hpsc_shmem_bcast_slot *slot;
+    uint32_t head;
+    uint32_t oldest;
+    uint32_t n_lost = 0;
+    assert(r);
+    assert(msg);
+    assert(sz >= HPSC_MSG_SIZE);
+    if (r->hdr->magic != HPSC_SHMEM_BCAST_MAGIC)
+        return 0; // destroyed
+    for (;;) {
+        head = r->hdr->seq;
+        if (head == r->cursor - 1)
+            break; // caught up
+        // unsigned arithmetic, so wraparound is harmless
+        if (head - r->cursor > r->mask) {
+            // lapped: skip to the oldest message still in the ring, though the
+            // writer may overwrite it before we're done (caught below)
+            oldest = head - r->mask;
+            n_lost += oldest - r->cursor;
+            r->cursor = oldest;
+        }
+        slot = &r->hdr->slots[(r->cursor - 1) & r->mask];
+        atomic_thread_fence(memory_order_acquire);
+        if (slot->seq == r->cursor) {
+            mem_vcpy(msg, slot->data, HPSC_MSG_SIZE);
+            atomic_thread_fence(memory_order_acquire);
+            if (slot->seq == r->cursor) {
+                r->cursor++;
+                if (lost)
+                    *lost = n_lost;
+                return HPSC_MSG_SIZE;
+            }
+        }
+        // the writer lapped us while we were reading -- try again from head
+        n_lost++;
+        r->cursor++;
+    }
+    if (lost)
+        *lost = n_lost;
+    return 0;
+}
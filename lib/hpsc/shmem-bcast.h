@@ -0,0 +1,87 @@
+#ifndef SHMEM_BCAST_H
+#define SHMEM_BCAST_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "doorbell.h"
+#include "hpsc-msg.h"
+
+// All subsystems must understand these structures and their protocol.
+// A single writer publishes messages to a ring of slots, numbering them with
+// consecutive sequence numbers starting at 1. Message n is written to slot
+// (n - 1) % num_slots, and the header's seq holds the last published number.
+// Readers never write to the region: each tracks its own cursor, and detects
+// that the writer lapped it when a slot's seq doesn't match the expected
+// number, before or after copying the message out.
+// While a slot is being rewritten, its seq is one less than the new number,
+// which never matches a number that maps to the slot since num_slots is a
+// power of two greater than one. This holds across 32-bit wraparound too.
+#define HPSC_SHMEM_BCAST_MAGIC 0x42434153 // "BCAS"
+struct hpsc_shmem_bcast_slot {
+    uint32_t seq;
+    uint32_t reserved;
+    uint8_t data[HPSC_MSG_SIZE];
+};
+
+struct hpsc_shmem_bcast_hdr {
+    uint32_t magic;
+    uint32_t num_slots;
+    uint32_t seq;
+    uint32_t reserved;
+    struct hpsc_shmem_bcast_slot slots[];
+};
+
+struct shmem_bcast;
+
+struct shmem_bcast_reader;
+
+/**
+ * Create a broadcast channel in the shared memory region at addr, which is
+ * overwritten. The ring uses as many slots as fit, rounded down to a power of
+ * two (at least two).
+ * If a doorbell is provided, it is rung after each message is published, and
+ * the channel takes ownership of it and closes it on destroy.
+ * May not be called from an interrupt context.
+ */
+struct shmem_bcast *shmem_bcast_create(uintptr_t addr, size_t size,
+                                       struct doorbell *db);
+
+/**
+ * Destroy a broadcast channel. Readers see no further messages.
+ * May not be called from an interrupt context.
+ */
+void shmem_bcast_destroy(struct shmem_bcast *b);
+
+/**
+ * Publish a message to all readers, without waiting for any of them.
+ * May be called from an interrupt context.
+ * Returns the message's sequence number.
+ */
+uint32_t shmem_bcast_publish(struct shmem_bcast *b, void *msg, size_t sz);
+
+/**
+ * Open a reader on a broadcast channel at addr, as created by any subsystem.
+ * The reader only receives messages published after it is opened.
+ * May not be called from an interrupt context.
+ * Returns NULL if the channel isn't initialized.
+ */
+struct shmem_bcast_reader *shmem_bcast_reader_open(uintptr_t addr);
+
+/**
+ * Close a reader.
+ * May not be called from an interrupt context.
+ */
+void shmem_bcast_reader_close(struct shmem_bcast_reader *r);
+
+/**
+ * Read the next message, if any.
+ * If the writer lapped the reader, the reader skips to the oldest message still
+ * available and the number of messages it missed is reported in lost.
+ * Each reader may only be used by one task at a time.
+ * Returns the number of bytes read (HPSC_MSG_SIZE), or 0 if there's no message.
+ */
+size_t shmem_bcast_read(struct shmem_bcast_reader *r, void *msg, size_t sz,
+                        uint32_t *lost);
+
+#endif // SHMEM_BCAST_H
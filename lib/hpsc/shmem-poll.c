@@ -9,6 +9,7 @@
 
 #include "shmem.h"
 #include "shmem-poll.h"
+#include "task-join.h"
 
 #define SHM_EVENT_EXIT RTEMS_EVENT_0
 
@@ -18,7 +19,7 @@ struct shmem_poll {
     rtems_interrupt_handler cb;
     void *cb_arg;
     rtems_id tid;
-    bool running;
+    struct task_join join;
     uint32_t status_mask;
 };
 
@@ -39,8 +40,7 @@ static rtems_task shm_poll_task(rtems_task_argument arg)
         if (status)
             sp->cb(sp->cb_arg);
     }
-    sp->running = false;
-    rtems_task_exit();
+    task_join_exit(&sp->join);
 }
 
 static void shmem_poll_init(
@@ -59,7 +59,6 @@ static void shmem_poll_init(
     sp->cb = cb;
     sp->cb_arg = cb_arg;
     sp->tid = task_id;
-    sp->running = true;
 }
 
 rtems_status_code shmem_poll_task_start(
@@ -81,7 +80,8 @@ rtems_status_code shmem_poll_task_start(
     if (!*sp)
         return RTEMS_NO_MEMORY;
     shmem_poll_init(*sp, shm, poll_ticks, status_mask, task_id, cb, cb_arg);
-    sc = rtems_task_start(task_id, shm_poll_task, (rtems_task_argument) *sp);
+    sc = task_join_start(&(*sp)->join, task_id, shm_poll_task,
+                         (rtems_task_argument) *sp);
     if (sc != RTEMS_SUCCESSFUL)
         goto free_sp;
     return RTEMS_SUCCESSFUL;
@@ -99,8 +99,7 @@ rtems_status_code shmem_poll_task_destroy(struct shmem_poll *sp)
     sc = rtems_event_send(sp->tid, SHM_EVENT_EXIT);
     if (sc == RTEMS_SUCCESSFUL) {
         assert(sp->tid != rtems_task_self());
-        while (sp->running) // wait for task to complete
-            rtems_task_wake_after(RTEMS_YIELD_PROCESSOR);
+        task_join_wait(&sp->join);
         free(sp);
     }
     return sc;
@@ -10,8 +10,33 @@
 
 struct shmem {
     volatile struct hpsc_shmem_region *shm;
+    enum shmem_mode mode;
 };
 
+// Cacheable regions are accessed through regular pointers so that copies run at
+// cached speed -- coherence is maintained explicitly, only where we publish or
+// consume data.
+#define SHM_CACHED(s) ((struct hpsc_shmem_region *)(s)->shm)
+
+static bool is_cacheable(struct shmem *s)
+{
+    return s->mode == SHMEM_MODE_CACHEABLE;
+}
+
+static void status_invalidate(struct shmem *s)
+{
+    if (is_cacheable(s))
+        rtems_cache_invalidate_multiple_data_lines(&SHM_CACHED(s)->status,
+                                                   sizeof(s->shm->status));
+}
+
+static void status_flush(struct shmem *s)
+{
+    if (is_cacheable(s))
+        rtems_cache_flush_multiple_data_lines(&SHM_CACHED(s)->status,
+                                              sizeof(s->shm->status));
+}
+
 static volatile void *vmem_set(volatile void *s, int c, unsigned n)
 {
     volatile uint8_t *bs = s;
@@ -52,12 +77,17 @@ static void *mem_vcpy(void *restrict dest, volatile void *restrict src,
 
 #define IS_ALIGNED(p) (((uintptr_t)(const void *)(p) % sizeof(uint32_t)) == 0)
 
-struct shmem *shmem_open(uintptr_t addr)
+struct shmem *shmem_open(uintptr_t addr, enum shmem_mode mode)
 {
     struct shmem *s = malloc(sizeof(struct shmem));
     assert(IS_ALIGNED(addr));
-    if (s)
+    // invalidating must not discard anybody else's data
+    assert(mode != SHMEM_MODE_CACHEABLE ||
+           !(addr % rtems_cache_get_data_line_size()));
+    if (s) {
         s->shm = (volatile struct hpsc_shmem_region *)addr;
+        s->mode = mode;
+    }
     return s;
 }
 
@@ -74,9 +104,18 @@ size_t shmem_write(struct shmem *s, const void *msg, size_t sz)
     assert(msg);
     assert(IS_ALIGNED(msg));
     assert(sz <= HPSC_MSG_SIZE);
-    vmem_cpy(s->shm->data, msg, sz);
-    if (sz_rem)
-        vmem_set(s->shm->data + sz, 0, sz_rem);
+    if (is_cacheable(s)) {
+        memcpy(SHM_CACHED(s)->data, msg, sz);
+        if (sz_rem)
+            memset(SHM_CACHED(s)->data + sz, 0, sz_rem);
+        // publish before the caller sets the status
+        rtems_cache_flush_multiple_data_lines(SHM_CACHED(s)->data,
+                                              HPSC_MSG_SIZE);
+    } else {
+        vmem_cpy(s->shm->data, msg, sz);
+        if (sz_rem)
+            vmem_set(s->shm->data + sz, 0, sz_rem);
+    }
     return sz;
 }
 
@@ -86,42 +125,50 @@ size_t shmem_read(struct shmem *s, void *msg, size_t sz)
     assert(msg);
     assert(IS_ALIGNED(msg));
     assert(sz >= HPSC_MSG_SIZE);
-    mem_vcpy(msg, s->shm->data, HPSC_MSG_SIZE);
+    if (is_cacheable(s)) {
+        rtems_cache_invalidate_multiple_data_lines(SHM_CACHED(s)->data,
+                                                   HPSC_MSG_SIZE);
+        memcpy(msg, SHM_CACHED(s)->data, HPSC_MSG_SIZE);
+    } else {
+        mem_vcpy(msg, s->shm->data, HPSC_MSG_SIZE);
+    }
     return HPSC_MSG_SIZE;
 }
 
 uint32_t shmem_get_status(struct shmem *s)
 {
     assert(s);
+    status_invalidate(s);
     return s->shm->status;
 }
 
 bool shmem_is_new(struct shmem *s)
 {
-    assert(s);
-    return s->shm->status & HPSC_SHMEM_STATUS_BIT_NEW;
+    return shmem_get_status(s) & HPSC_SHMEM_STATUS_BIT_NEW;
 }
 
 bool shmem_is_ack(struct shmem *s)
 {
-    assert(s);
-    return s->shm->status & HPSC_SHMEM_STATUS_BIT_ACK;
+    return shmem_get_status(s) & HPSC_SHMEM_STATUS_BIT_ACK;
 }
 
-void shmem_set_new(struct shmem *s, bool val)
+static void shmem_set_status_bit(struct shmem *s, uint32_t bit, bool val)
 {
     assert(s);
+    status_invalidate(s);
     if (val)
-        s->shm->status |= HPSC_SHMEM_STATUS_BIT_NEW;
+        s->shm->status |= bit;
     else
-        s->shm->status &= ~HPSC_SHMEM_STATUS_BIT_NEW;
+        s->shm->status &= ~bit;
+    status_flush(s);
+}
+
+void shmem_set_new(struct shmem *s, bool val)
+{
+    shmem_set_status_bit(s, HPSC_SHMEM_STATUS_BIT_NEW, val);
 }
 
 void shmem_set_ack(struct shmem *s, bool val)
 {
-    assert(s);
-    if (val)
-        s->shm->status |= HPSC_SHMEM_STATUS_BIT_ACK;
-    else
-        s->shm->status &= ~HPSC_SHMEM_STATUS_BIT_ACK;
+    shmem_set_status_bit(s, HPSC_SHMEM_STATUS_BIT_ACK, val);
 }
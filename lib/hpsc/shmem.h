@@ -19,10 +19,22 @@ struct hpsc_shmem_region {
 
 struct shmem;
 
+/**
+ * How the local CPU maps a shared memory region.
+ * Cacheable regions must be aligned to a cache line and must not share cache
+ * lines with other data. The library cleans the lines it writes when publishing
+ * and invalidates the lines it reads before consuming, so the region's memory
+ * attributes must actually be cacheable (e.g., configured in the MPU).
+ */
+enum shmem_mode {
+    SHMEM_MODE_UNCACHED,
+    SHMEM_MODE_CACHEABLE
+};
+
 /**
  * Open a shared memory region.
  */
-struct shmem *shmem_open(uintptr_t addr);
+struct shmem *shmem_open(uintptr_t addr, enum shmem_mode mode);
 
 /**
  * Close a shared memory region.
@@ -0,0 +1,41 @@
+#include <stdbool.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+
+#include "task-join.h"
+
+rtems_status_code task_join_start(struct task_join *j, rtems_id task_id,
+                                  rtems_task_entry entry,
+                                  rtems_task_argument arg)
+{
+    rtems_status_code sc;
+    rtems_binary_semaphore_init(&j->exited, "Task Join");
+    j->running = true;
+    sc = rtems_task_start(task_id, entry, arg);
+    if (sc != RTEMS_SUCCESSFUL) {
+        j->running = false;
+        rtems_binary_semaphore_destroy(&j->exited);
+    }
+    return sc;
+}
+
+void task_join_exit(struct task_join *j)
+{
+    j->running = false;
+    // the joiner may reuse j once woken, so it's not touched after
+    rtems_binary_semaphore_post(&j->exited);
+    rtems_task_exit();
+}
+
+void task_join_wait(struct task_join *j)
+{
+    rtems_binary_semaphore_wait(&j->exited);
+    rtems_binary_semaphore_destroy(&j->exited);
+}
+
+void task_join_abandon(struct task_join *j)
+{
+    j->running = false;
+    rtems_binary_semaphore_destroy(&j->exited);
+}
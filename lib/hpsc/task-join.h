@@ -0,0 +1,52 @@
+#ifndef TASK_JOIN_H
+#define TASK_JOIN_H
+
+#include <stdbool.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+
+// Joining tasks: a task that exits (e.g., when asked to by an event) signals a
+// semaphore on its way out, so whoever stopped it blocks until it's done,
+// instead of polling a flag.
+// Callers still create tasks (and set their affinity), as elsewhere.
+
+// Zero-initialized, e.g., static, is not running.
+struct task_join {
+    rtems_binary_semaphore exited;
+    volatile bool running;
+};
+
+/**
+ * Start a task that will exit with task_join_exit.
+ */
+rtems_status_code task_join_start(struct task_join *j, rtems_id task_id,
+                                  rtems_task_entry entry,
+                                  rtems_task_argument arg);
+
+/**
+ * Exit the calling task, which was started with task_join_start.
+ */
+RTEMS_NO_RETURN void task_join_exit(struct task_join *j);
+
+/**
+ * Wait for a task to exit (if it hasn't already), after which it may be
+ * started again. Must be called once per start, and not by the task itself.
+ */
+void task_join_wait(struct task_join *j);
+
+/**
+ * Give up on a running task that can't be asked to exit (e.g., an event send
+ * failed), so it may be started again. Instead of task_join_wait, not both.
+ */
+void task_join_abandon(struct task_join *j);
+
+/**
+ * Check whether a task was started and hasn't exited yet.
+ */
+static inline bool task_join_is_running(const struct task_join *j)
+{
+    return j->running;
+}
+
+#endif // TASK_JOIN_H
@@ -0,0 +1,170 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/capture.h>
+#include <rtems/score/threadimpl.h>
+#include <rtems/score/timestamp.h>
+
+#include "affinity.h"
+#include "task-table.h"
+
+// The stack checker fills each stack with this when its task is created
+#define TASK_STACK_FILL 0xA5A5A5A5
+
+struct task_stats_find {
+    rtems_id id;
+    struct task_stats *stats;
+    bool found;
+};
+
+static void task_spec_delete(struct task_spec *spec)
+{
+    uint32_t i;
+    // started tasks that were stopped have already exited
+    for (i = 0; i < spec->num_tasks; i++)
+        rtems_task_delete(spec->task_ids[i]);
+    spec->num_tasks = 0;
+}
+
+static rtems_status_code task_spec_start(struct task_spec *spec)
+{
+    rtems_status_code sc;
+    uint32_t n = spec->instances;
+    uint32_t i;
+    assert(n <= TASK_SPEC_INSTANCES_MAX);
+    assert(!spec->pin || spec->per_cpu);
+    assert(spec->start);
+    assert(!spec->num_tasks);
+
+    if (spec->per_cpu && n > rtems_get_processor_count())
+        n = rtems_get_processor_count();
+    for (i = 0; i < n; i++) {
+        sc = rtems_task_create(
+            spec->name + i, spec->priority, spec->stack_size,
+            RTEMS_DEFAULT_MODES, RTEMS_DEFAULT_ATTRIBUTES, &spec->task_ids[i]
+        );
+        if (sc != RTEMS_SUCCESSFUL)
+            goto fail;
+        spec->num_tasks++;
+        if (spec->pin) {
+            sc = affinity_pin_to_cpu(spec->task_ids[i], i);
+            if (sc != RTEMS_SUCCESSFUL)
+                goto fail;
+        }
+    }
+    sc = spec->start(spec->task_ids, spec->num_tasks);
+    if (sc != RTEMS_SUCCESSFUL)
+        goto fail;
+    return RTEMS_SUCCESSFUL;
+fail:
+    task_spec_delete(spec);
+    return sc;
+}
+
+rtems_status_code task_table_start(struct task_spec *table, size_t len)
+{
+    rtems_status_code sc;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        sc = task_spec_start(&table[i]);
+        if (sc != RTEMS_SUCCESSFUL) {
+            printf("Failed to start %s\n", table[i].desc);
+            task_table_stop(table, i);
+            return sc;
+        }
+    }
+    return RTEMS_SUCCESSFUL;
+}
+
+rtems_status_code task_table_stop(struct task_spec *table, size_t len)
+{
+    rtems_status_code rc = RTEMS_SUCCESSFUL;
+    rtems_status_code sc;
+    struct task_spec *spec;
+    size_t i = len;
+    while (i--) {
+        spec = &table[i];
+        if (!spec->num_tasks || !spec->stop)
+            continue;
+        printf("Stopping %s...\n", spec->desc);
+        sc = spec->stop();
+        if (sc != RTEMS_SUCCESSFUL) {
+            printf("Failed to stop %s\n", spec->desc);
+            if (rc == RTEMS_SUCCESSFUL)
+                rc = sc;
+            continue;
+        }
+        // they exited, so there's nothing to delete
+        spec->num_tasks = 0;
+    }
+    return rc;
+}
+
+static size_t task_stack_used(const Stack_Control *stack)
+{
+    const uint32_t *p = stack->area;
+    const uint32_t *end = p + stack->size / sizeof(*p);
+    // stacks grow down: skip the stack checker's guard pattern at the bottom,
+    // then whatever of the fill was never overwritten
+    while (p < end && *p != TASK_STACK_FILL)
+        p++;
+    if (p == end)
+        return 0;
+    while (p < end && *p == TASK_STACK_FILL)
+        p++;
+    return (end - p) * sizeof(*p);
+}
+
+static bool task_stats_visitor(rtems_tcb *tcb, void *arg)
+{
+    struct task_stats_find *find = arg;
+    Timestamp_Control used;
+    if (rtems_capture_task_id(tcb) != find->id)
+        return false;
+    _Thread_Get_CPU_time_used(tcb, &used);
+    find->stats->cpu_ns = _Timestamp_Get_as_nanoseconds(&used);
+    find->stats->stack_size = tcb->Start.Initial_stack.size;
+    find->stats->stack_used = task_stack_used(&tcb->Start.Initial_stack);
+    find->found = true;
+    return true;
+}
+
+rtems_status_code task_table_get_stats(const struct task_spec *spec,
+                                       uint32_t instance,
+                                       struct task_stats *stats)
+{
+    struct task_stats_find find = {
+        .stats = stats,
+        .found = false
+    };
+    assert(spec);
+    assert(stats);
+    if (instance >= spec->num_tasks)
+        return RTEMS_INVALID_NUMBER;
+    find.id = spec->task_ids[instance];
+    stats->name = spec->name + instance;
+    rtems_task_iterate(task_stats_visitor, &find);
+    return find.found ? RTEMS_SUCCESSFUL : RTEMS_INVALID_ID;
+}
+
+void task_table_print_stats(const struct task_spec *table, size_t len)
+{
+    struct task_stats stats;
+    size_t i;
+    uint32_t j;
+    for (i = 0; i < len; i++) {
+        for (j = 0; j < table[i].num_tasks; j++) {
+            if (task_table_get_stats(&table[i], j, &stats) !=
+                    RTEMS_SUCCESSFUL)
+                continue;
+            printf("%s %"PRIu32": cpu %10"PRIu64" us: stack %zu/%zu bytes\n",
+                   table[i].desc, j, stats.cpu_ns / 1000, stats.stack_used,
+                   stats.stack_size);
+        }
+    }
+}
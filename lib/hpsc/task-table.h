@@ -0,0 +1,75 @@
+#ifndef TASK_TABLE_H
+#define TASK_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+
+// Task tables: an application declares its tasks (name, priority, stack and
+// CPU affinity) in a table, which creates them and hands them to whatever
+// starts them, usually a library, and later has them stopped and joined (see
+// task-join.h) in reverse order.
+// Not synchronized, a table must be started and stopped by one task at a time.
+
+#define TASK_SPEC_INSTANCES_MAX 4
+
+/**
+ * Start created tasks, e.g., with a library's task start function.
+ */
+typedef rtems_status_code (*task_spec_start_t)(const rtems_id *task_ids,
+                                               uint32_t num_tasks);
+
+/**
+ * Stop the started tasks, returning once they've exited.
+ */
+typedef rtems_status_code (*task_spec_stop_t)(void);
+
+struct task_spec {
+    const char *desc;
+    rtems_name name; // the instance index is added to the last character
+    rtems_task_priority priority;
+    size_t stack_size;
+    uint32_t instances;
+    bool per_cpu; // no more instances than CPUs
+    bool pin; // instance i only runs on CPU i, requires per_cpu
+    task_spec_start_t start;
+    task_spec_stop_t stop; // NULL if the tasks run forever
+    // the created tasks, zero-initialized
+    rtems_id task_ids[TASK_SPEC_INSTANCES_MAX];
+    uint32_t num_tasks;
+};
+
+struct task_stats {
+    rtems_name name;
+    uint64_t cpu_ns;
+    size_t stack_size;
+    size_t stack_used; // high-water mark, 0 if unknown (no stack checker)
+};
+
+/**
+ * Create and start each entry's tasks, in order. If an entry fails, its tasks
+ * are deleted and earlier entries are stopped.
+ */
+rtems_status_code task_table_start(struct task_spec *table, size_t len);
+
+/**
+ * Stop each started entry's tasks, in reverse order. Entries that fail to stop
+ * are skipped, and the first failure is returned.
+ */
+rtems_status_code task_table_stop(struct task_spec *table, size_t len);
+
+/**
+ * Get the CPU time and stack usage of an entry's started task.
+ */
+rtems_status_code task_table_get_stats(const struct task_spec *spec,
+                                       uint32_t instance,
+                                       struct task_stats *stats);
+
+/**
+ * Print the stats of each started task to stdout.
+ */
+void task_table_print_stats(const struct task_spec *table, size_t len);
+
+#endif // TASK_TABLE_H
@@ -0,0 +1,93 @@
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hpsc-msg.h"
+#include "telemetry.h"
+
+struct telemetry_event_desc {
+    const char *name;
+    const char *fields;
+};
+
+#define TELEMETRY_EVENT_DESC(id, name, fields) [id] = { name, fields },
+static const struct telemetry_event_desc events[] = {
+    TELEMETRY_EVENTS(TELEMETRY_EVENT_DESC)
+};
+#undef TELEMETRY_EVENT_DESC
+
+#define TELEMETRY_STR(id, str) [id] = str,
+static const char *const strs[] = {
+    TELEMETRY_STRS(TELEMETRY_STR)
+};
+#undef TELEMETRY_STR
+
+const char *telemetry_event_name(unsigned event)
+{
+    return event < TELEMETRY_EVENT_COUNT ? events[event].name : NULL;
+}
+
+const char *telemetry_str(uint32_t str)
+{
+    return str < TELEMETRY_STR_COUNT ? strs[str] : NULL;
+}
+
+// like snprintf, at offset len of the text so far
+static int telemetry_append(char *buf, size_t sz, int len, const char *fmt,
+                            ...)
+{
+    va_list args;
+    size_t off;
+    int n;
+    if (len < 0)
+        return len;
+    off = (size_t) len < sz ? (size_t) len : sz;
+    va_start(args, fmt);
+    n = vsnprintf(buf + off, sz - off, fmt, args);
+    va_end(args);
+    return n < 0 ? n : len + n;
+}
+
+int telemetry_snprint(char *buf, size_t sz, const void *msg)
+{
+    const struct hpsc_msg_telemetry_payload *p = hpsc_msg_telemetry_decode(msg);
+    const char *name;
+    const char *str;
+    const char *field = "";
+    size_t field_len;
+    unsigned nfields;
+    unsigned i;
+    int len = 0;
+    if (!p)
+        return -1;
+    name = telemetry_event_name(p->event);
+    if (name) {
+        len = telemetry_append(buf, sz, len, "%s", name);
+        field = events[p->event].fields;
+    } else {
+        len = telemetry_append(buf, sz, len, "event %u", p->event);
+    }
+    len = telemetry_append(buf, sz, len, " status=%u", p->status);
+    str = telemetry_str(p->str);
+    if (!str)
+        len = telemetry_append(buf, sz, len, " str=%u", (unsigned) p->str);
+    else if (*str)
+        len = telemetry_append(buf, sz, len, " \"%s\"", str);
+    nfields = p->nfields < HPSC_MSG_TELEMETRY_FIELDS_MAX ?
+        p->nfields : HPSC_MSG_TELEMETRY_FIELDS_MAX;
+    for (i = 0; i < nfields; i++) {
+        // fields without names are numbered
+        field += strspn(field, " ");
+        field_len = strcspn(field, " ");
+        if (field_len)
+            len = telemetry_append(buf, sz, len, " %.*s=%u", (int) field_len,
+                                   field, (unsigned) p->fields[i]);
+        else
+            len = telemetry_append(buf, sz, len, " f%u=%u", i,
+                                   (unsigned) p->fields[i]);
+        field += field_len;
+    }
+    return len;
+}
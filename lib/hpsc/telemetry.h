@@ -0,0 +1,59 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Decoder tables for TELEMETRY messages (see hpsc-msg.h), shared by senders and
+// receivers: events with their field names, and interned strings.
+// IDs are part of the wire format, so only append to the tables.
+// Nothing here depends on RTEMS, so receivers on other subsystems may build it.
+
+// (id, name, field names separated by spaces)
+// Senders may omit trailing fields, e.g., LIFECYCLE's boot times (the uptime at
+// the end of each boot phase) are only in the UP event.
+#define TELEMETRY_EVENTS(X) \
+    X(TELEMETRY_EVENT_NONE, "none", "") \
+    X(TELEMETRY_EVENT_LIFECYCLE, "lifecycle", \
+      "uptime_ticks drivers_us standalone_tests_us services_us " \
+      "early_tasks_us runtime_tests_us links_us init_tasks_us " \
+      "external_tests_us late_tasks_us")
+
+// (id, string)
+#define TELEMETRY_STRS(X) \
+    X(TELEMETRY_STR_NONE, "") \
+    X(TELEMETRY_STR_RTPS_R52, "RTPS R52") \
+    X(TELEMETRY_STR_RTPS_R52_SHUTDOWN, "RTPS R52 shutdown")
+
+#define TELEMETRY_ENUM_EVENT(id, name, fields) id,
+enum telemetry_event {
+    TELEMETRY_EVENTS(TELEMETRY_ENUM_EVENT)
+    TELEMETRY_EVENT_COUNT
+};
+#undef TELEMETRY_ENUM_EVENT
+
+#define TELEMETRY_ENUM_STR(id, str) id,
+enum telemetry_str {
+    TELEMETRY_STRS(TELEMETRY_ENUM_STR)
+    TELEMETRY_STR_COUNT
+};
+#undef TELEMETRY_ENUM_STR
+
+/**
+ * Get an event's name, or NULL if unknown.
+ */
+const char *telemetry_event_name(unsigned event);
+
+/**
+ * Get an interned string, or NULL if unknown.
+ */
+const char *telemetry_str(uint32_t str);
+
+/**
+ * Decode a TELEMETRY message into text, e.g., for logging on the receiver.
+ * Returns the length of the text (which is truncated if it's sz or more, like
+ * snprintf), or -1 if the message isn't a TELEMETRY.
+ */
+int telemetry_snprint(char *buf, size_t sz, const void *msg);
+
+#endif // TELEMETRY_H
@@ -3,45 +3,82 @@
 
 #include <rtems.h>
 #include <rtems/score/percpudata.h>
+#include <rtems/thread.h>
 #include <bsp/hpsc-wdt.h>
 
+// drivers
+#include <hpsc-rti-timer.h>
+
+#include "health.h"
+#include "task-join.h"
 #include "watchdog-cpu.h"
 
 #define WDT_TASK_EXIT RTEMS_EVENT_0
 
 struct watchdog_task_ctx {
     struct HPSC_WDT_Config *wdt;
-    rtems_id tid;
+    struct health_group *health;
+    rtems_id tid; // task kicker
     rtems_interval ticks;
+    struct hpsc_rti_timer *rtit; // timer kicker
     rtems_interrupt_handler cb;
     void *cb_arg;
-    bool running;
+    rtems_status_code start_sc;
+    rtems_binary_semaphore started; // task kicker installed the ISR, or failed
+    struct task_join join;
+    bool running; // either kicker
 };
 
 static PER_CPU_DATA_ITEM(struct watchdog_task_ctx, tasks) = { 0 };
 
+static void watchdog_kick(struct watchdog_task_ctx *ctx)
+{
+    // a stuck task lets the WDT expire
+    if (!ctx->health || health_check(ctx->health))
+        wdt_kick(ctx->wdt);
+}
+
 static rtems_task watchdog_task(rtems_task_argument arg)
 {
     struct watchdog_task_ctx *ctx = (struct watchdog_task_ctx *)arg;
     rtems_event_set events;
+    rtems_status_code sc RTEMS_UNUSED;
     assert(ctx);
+
+    // the WDT interrupt is a PPI, so is installed from the task's own CPU
+    ctx->start_sc = wdt_handler_install(ctx->wdt, ctx->cb, ctx->cb_arg);
+    if (ctx->start_sc != RTEMS_SUCCESSFUL) {
+        rtems_binary_semaphore_post(&ctx->started);
+        task_join_exit(&ctx->join);
+    }
+    // once enabled, the WDT can't be stopped
+    wdt_enable(ctx->wdt);
+    rtems_binary_semaphore_post(&ctx->started);
+
     while (1) {
-        wdt_kick(ctx->wdt);
+        watchdog_kick(ctx);
         rtems_event_receive(WDT_TASK_EXIT, RTEMS_EVENT_ANY, ctx->ticks,
                             &events);
         if (events & WDT_TASK_EXIT)
             break;
     }
-    ctx->running = false;
-    rtems_task_exit();
+    // we can't actually disable the WDT, only remove our ISR
+    sc = wdt_handler_remove(ctx->wdt, ctx->cb, ctx->cb_arg);
+    // we installed the handler, so we can safely assert its removal
+    assert(sc == RTEMS_SUCCESSFUL);
+    task_join_exit(&ctx->join);
 }
 
+#define WATCHDOG_TASK_CTX(cpu) \
+    PER_CPU_DATA_GET(_Per_CPU_Get_by_index(cpu), struct watchdog_task_ctx, \
+                     tasks)
 #define PER_CPU_WATCHDOG_TASK_CTX \
-    PER_CPU_DATA_GET(_Per_CPU_Get_by_index(rtems_get_current_processor()), \
-                     struct watchdog_task_ctx, tasks)
+    WATCHDOG_TASK_CTX(rtems_get_current_processor())
 
 rtems_status_code watchdog_cpu_task_start(
+    uint32_t cpu,
     struct HPSC_WDT_Config *wdt,
+    struct health_group *health,
     rtems_id task_id,
     rtems_interval ticks,
     rtems_interrupt_handler cb,
@@ -50,17 +87,94 @@ rtems_status_code watchdog_cpu_task_start(
 {
     struct watchdog_task_ctx *ctx;
     rtems_status_code sc;
-    rtems_status_code sc_tmp RTEMS_UNUSED;
     assert(wdt);
+    assert(cpu < rtems_get_processor_count());
 
-    ctx = PER_CPU_WATCHDOG_TASK_CTX;
+    ctx = WATCHDOG_TASK_CTX(cpu);
     assert(ctx);
     if (ctx->running)
         return RTEMS_UNSATISFIED;
 
     ctx->wdt = wdt;
+    ctx->health = health;
     ctx->tid = task_id;
     ctx->ticks = ticks;
+    ctx->rtit = NULL;
+    ctx->cb = cb;
+    ctx->cb_arg = cb_arg;
+    ctx->running = true;
+    rtems_binary_semaphore_init(&ctx->started, "WDT Task Started");
+
+    sc = task_join_start(&ctx->join, task_id, watchdog_task,
+                         (rtems_task_argument)ctx);
+    if (sc != RTEMS_SUCCESSFUL)
+        goto out;
+    // wait for task to install the ISR
+    rtems_binary_semaphore_wait(&ctx->started);
+    sc = ctx->start_sc;
+    if (sc != RTEMS_SUCCESSFUL)
+        task_join_wait(&ctx->join); // it exits right away
+out:
+    if (sc != RTEMS_SUCCESSFUL)
+        ctx->running = false;
+    rtems_binary_semaphore_destroy(&ctx->started);
+    return sc;
+}
+
+rtems_status_code watchdog_cpu_task_stop(uint32_t cpu)
+{
+    struct watchdog_task_ctx *ctx;
+    rtems_status_code sc = RTEMS_NOT_DEFINED;
+    assert(cpu < rtems_get_processor_count());
+
+    ctx = WATCHDOG_TASK_CTX(cpu);
+    assert(ctx);
+
+    if (ctx->running && !ctx->rtit) {
+        sc = rtems_event_send(ctx->tid, WDT_TASK_EXIT);
+        if (sc == RTEMS_SUCCESSFUL) {
+            task_join_wait(&ctx->join);
+            ctx->running = false;
+        }
+    }
+
+    return sc;
+}
+
+// The RTI timers of all CPUs share a PPI vector, so each CPU's interrupt calls
+// the kickers of all CPUs, on the interrupted CPU.
+static void watchdog_timer_isr(void *arg)
+{
+    struct watchdog_task_ctx *ctx = (struct watchdog_task_ctx *)arg;
+    if (ctx == PER_CPU_WATCHDOG_TASK_CTX)
+        watchdog_kick(ctx);
+}
+
+rtems_status_code watchdog_cpu_timer_start(
+    struct HPSC_WDT_Config *wdt,
+    struct health_group *health,
+    struct hpsc_rti_timer *tmr,
+    uint64_t interval_ns,
+    rtems_interrupt_handler cb,
+    void *cb_arg
+)
+{
+    struct watchdog_task_ctx *ctx;
+    rtems_status_code sc;
+    rtems_status_code sc_tmp RTEMS_UNUSED;
+    assert(wdt);
+    assert(tmr);
+
+    ctx = PER_CPU_WATCHDOG_TASK_CTX;
+    assert(ctx);
+    if (ctx->running)
+        return RTEMS_UNSATISFIED;
+
+    ctx->wdt = wdt;
+    ctx->health = health;
+    ctx->tid = RTEMS_ID_NONE;
+    ctx->ticks = 0;
+    ctx->rtit = tmr;
     ctx->cb = cb;
     ctx->cb_arg = cb_arg;
     ctx->running = true;
@@ -72,21 +186,24 @@ rtems_status_code watchdog_cpu_task_start(
 
     // once enabled, the WDT can't be stopped
     wdt_enable(wdt);
-    sc = rtems_task_start(task_id, watchdog_task, (rtems_task_argument)ctx);
+    watchdog_kick(ctx);
+    sc = hpsc_rti_timer_start(tmr, watchdog_timer_isr, ctx);
     if (sc != RTEMS_SUCCESSFUL) {
         sc_tmp = wdt_handler_remove(wdt, cb, cb_arg);
         // we installed the handler, so we can safely assert its removal
         assert(sc_tmp == RTEMS_SUCCESSFUL);
         goto fail;
     }
+    hpsc_rti_timer_configure(tmr, interval_ns);
 
     return sc;
 fail:
+    ctx->rtit = NULL;
     ctx->running = false;
     return sc;
 }
 
-rtems_status_code watchdog_cpu_task_stop(void)
+rtems_status_code watchdog_cpu_timer_stop(uint64_t reset_interval_ns)
 {
     struct watchdog_task_ctx *ctx;
     rtems_status_code sc = RTEMS_NOT_DEFINED;
@@ -94,16 +211,17 @@ rtems_status_code watchdog_cpu_task_stop(void)
     ctx = PER_CPU_WATCHDOG_TASK_CTX;
     assert(ctx);
 
-    if (ctx->running) {
-        // we can't actually disable the WDT, only remove our ISR
+    if (ctx->running && ctx->rtit) {
+        // the RTI timer can't be disabled either
+        hpsc_rti_timer_configure(ctx->rtit, reset_interval_ns);
+        sc = hpsc_rti_timer_stop(ctx->rtit, watchdog_timer_isr, ctx);
+        if (sc != RTEMS_SUCCESSFUL)
+            return sc;
         sc = wdt_handler_remove(ctx->wdt, ctx->cb, ctx->cb_arg);
         // we installed the handler, so we can safely assert its removal
         assert(sc == RTEMS_SUCCESSFUL);
-        sc = rtems_event_send(ctx->tid, WDT_TASK_EXIT);
-        if (sc == RTEMS_SUCCESSFUL) {
-            while (ctx->running) // wait for task to finish
-                rtems_task_wake_after(RTEMS_YIELD_PROCESSOR);
-        }
+        ctx->rtit = NULL;
+        ctx->running = false;
     }
 
     return sc;
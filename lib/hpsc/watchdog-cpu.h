@@ -5,12 +5,22 @@
 #include <rtems/irq-extension.h>
 #include <bsp/hpsc-wdt.h>
 
+// drivers
+#include <hpsc-rti-timer.h>
+
+#include "health.h"
+
 /**
- * Start the watchdog kicker task for the current CPU.
- * The caller is responsible for pinning the task to the appropriate CPU.
+ * Start the watchdog kicker task for a CPU, which may be called from any CPU.
+ * The caller is responsible for pinning the task to the appropriate CPU, where
+ * it installs the timeout ISR and enables the WDT before this returns.
+ * Every ticks, the task kicks the WDT if the health group is healthy (see
+ * health_check), or unconditionally if health is NULL.
  */
 rtems_status_code watchdog_cpu_task_start(
+    uint32_t cpu,
     struct HPSC_WDT_Config *wdt,
+    struct health_group *health,
     rtems_id task_id,
     rtems_interval ticks,
     rtems_interrupt_handler cb,
@@ -18,8 +28,31 @@ rtems_status_code watchdog_cpu_task_start(
 );
 
 /**
- * Stop the watchdog kicker task for the current CPU.
+ * Stop the watchdog kicker task for a CPU, which may be called from any CPU.
+ */
+rtems_status_code watchdog_cpu_task_stop(uint32_t cpu);
+
+/**
+ * Start kicking the current CPU's watchdog from an interrupt of the CPU's RTI
+ * timer every interval_ns, instead of from a task, which saves the task's
+ * stack and its context switches. The kicks are gated by the health group and
+ * the timeout ISR is installed as with watchdog_cpu_task_start.
+ * The timer must not be used by anything else until stopped.
+ * Must be called on the CPU that the timer and watchdog belong to.
+ */
+rtems_status_code watchdog_cpu_timer_start(
+    struct HPSC_WDT_Config *wdt,
+    struct health_group *health,
+    struct hpsc_rti_timer *tmr,
+    uint64_t interval_ns,
+    rtems_interrupt_handler cb,
+    void *cb_arg
+);
+
+/**
+ * Stop kicking the current CPU's watchdog from its RTI timer, setting the
+ * timer's interval to reset_interval_ns since it can't be disabled.
  */
-rtems_status_code watchdog_cpu_task_stop(void);
+rtems_status_code watchdog_cpu_timer_stop(uint64_t reset_interval_ns);
 
 #endif // WATCHDOG_CPU_H
@@ -58,6 +58,12 @@
 #define LSIO_MBOX0_CHAN__RTPS_R52_SMP_SSW__TRCH_SSW 0
 #define LSIO_MBOX0_CHAN__TRCH_SSW__RTPS_R52_SMP_SSW 1
 
+// RTPS R52 SSW <-> TRCH SSW shared memory link doorbells (no data)
+#define LSIO_MBOX0_CHAN__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW__DOORBELL 6
+#define LSIO_MBOX0_CHAN__TRCH_SSW__RTPS_R52_LOCKSTEP_SSW__DOORBELL 7
+#define LSIO_MBOX0_CHAN__RTPS_R52_SMP_SSW__TRCH_SSW__DOORBELL 6
+#define LSIO_MBOX0_CHAN__TRCH_SSW__RTPS_R52_SMP_SSW__DOORBELL 7
+
 // RTPS A53 ATF <-> TRCH SSW
 #define LSIO_MBOX0_CHAN__RTPS_A53_ATF__TRCH_SSW__RQST 4
 #define LSIO_MBOX0_CHAN__RTPS_A53_ATF__TRCH_SSW__RPLY 5
@@ -39,6 +39,10 @@
 #define RTPS_DMA_DST_ADDR       0x40052000 // align to page
 #define RTPS_DMA_DST_REMAP_ADDR 0x40053000 // MMU test maps this to DST_ADDR
 
+// DMA Microcode buffer for memory access service bulk copies: in RTPS DRAM
+#define RTPS_DMA_MCODE_ADDR__MEM_ACCESS 0x40054000
+#define RTPS_DMA_MCODE_SIZE__MEM_ACCESS 0x00001000
+
 /* Allocations can overlap for subsystems that cannot run concurrently. */
 /* Note: SMP OS uses one region -- synchronization up to the SW */
 #define RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP			  0x40260000
@@ -67,10 +71,13 @@
 #define RTPS_DDR_SIZE__SHM__TRCH_SSW__RTPS_R52_SMP_SSW      	  0x00008000
 #define RTPS_DDR_ADDR__SHM__RTPS_R52_SMP_SSW__TRCH_SSW      	  0x40288000
 #define RTPS_DDR_SIZE__SHM__RTPS_R52_SMP_SSW__TRCH_SSW      	  0x00008000
+// RTPS SSW -> all subsystems: single-writer broadcast channel (shmem-bcast)
+#define RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP_SSW__BCAST	  0x40280000
+#define RTPS_DDR_SIZE__SHM__RTPS_R52_LOCKSTEP_SSW__BCAST	  0x00001000
 
 // Shared memory regions accessible to RTPS, reserved but not allocated
-#define RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP__FREE		  0x40280000
-#define RTPS_DDR_SIZE__SHM__RTPS_R52_LOCKSTEP__FREE		  0x00020000
+#define RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP__FREE		  0x40281000
+#define RTPS_DDR_SIZE__SHM__RTPS_R52_LOCKSTEP__FREE		  0x0001f000
 #define RTPS_DDR_ADDR__SHM__RTPS_R52_SPLIT_0__FREE		  0x402a0000
 #define RTPS_DDR_SIZE__SHM__RTPS_R52_SPLIT_0__FREE		  0x00000000
 #define RTPS_DDR_ADDR__SHM__RTPS_R52_SPLIT_1__FREE		  0x402a0000
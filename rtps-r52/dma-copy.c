@@ -0,0 +1,93 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+#include <bsp.h>
+#include <bsp/dma.h>
+#include <bsp/dma_330.h>
+
+#include "dma-copy.h"
+
+#define IS_ALIGNED(x) (((uintptr_t)(x) % sizeof(uint32_t)) == 0)
+
+struct dma_copy {
+    DMA_Config_t config;
+    DMA_Channel_t *channel;
+    rtems_mutex mtx;
+};
+
+struct dma_copy *dma_copy_create(uintptr_t mcode_addr, unsigned channel)
+{
+    struct dma_copy *dc;
+    rtems_status_code sc;
+    if (channel >= BSP_DMA_MAX_CHANNELS) {
+        printf("dma-copy: invalid channel: %u\n", channel);
+        return NULL;
+    }
+    dc = malloc(sizeof(*dc));
+    if (!dc)
+        return NULL;
+    dc->channel = (DMA_Channel_t *) mcode_addr;
+    sc = dma_init(&dc->config, BSP_DMA_BASE);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printf("dma-copy: init failed\n");
+        goto free_dc;
+    }
+    sc = dma_channel_alloc(&dc->config, dc->channel, channel);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printf("dma-copy: channel alloc failed\n");
+        goto uninit;
+    }
+    rtems_mutex_init(&dc->mtx, "DMA Copy");
+    return dc;
+
+uninit:
+    dma_uninit(&dc->config);
+free_dc:
+    free(dc);
+    return NULL;
+}
+
+void dma_copy_destroy(struct dma_copy *dc)
+{
+    rtems_status_code sc RTEMS_UNUSED;
+    assert(dc);
+    rtems_mutex_destroy(&dc->mtx);
+    sc = dma_channel_free(dc->channel);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = dma_uninit(&dc->config);
+    assert(sc == RTEMS_SUCCESSFUL);
+    free(dc);
+}
+
+int dma_copy(void *dest, const void *src, size_t sz, void *arg)
+{
+    struct dma_copy *dc = arg;
+    bool stopped = false;
+    bool faulted = false;
+    rtems_status_code sc;
+    assert(dc);
+    if (!IS_ALIGNED(dest) || !IS_ALIGNED(src) || !IS_ALIGNED(sz))
+        return 1;
+    rtems_cache_flush_multiple_data_lines(src, sz);
+    // so no dirty lines are evicted over the transfer
+    rtems_cache_flush_multiple_data_lines(dest, sz);
+    rtems_mutex_lock(&dc->mtx);
+    sc = dma_copy_memory_to_memory(dc->channel, dest, (uint32_t *) src, sz);
+    while (sc == RTEMS_SUCCESSFUL && !stopped && !faulted) {
+        sc = dma_channel_is_stopped(dc->channel, &stopped);
+        if (sc == RTEMS_SUCCESSFUL)
+            sc = dma_channel_is_faulted(dc->channel, &faulted);
+    }
+    rtems_mutex_unlock(&dc->mtx);
+    if (sc != RTEMS_SUCCESSFUL || faulted) {
+        printf("dma-copy: transfer failed\n");
+        return 1;
+    }
+    rtems_cache_invalidate_multiple_data_lines(dest, sz);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef DMA_COPY_H
+#define DMA_COPY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Memory-to-memory copies on a DMA channel, compatible with mem_access_copy_t.
+// Copies are serialized on the channel and busy-wait for completion.
+// Source and destination are flushed from the data cache before the copy, and
+// the destination is invalidated after it.
+
+struct dma_copy;
+
+/**
+ * Initialize the DMA controller and allocate a channel, whose microcode is
+ * written to the buffer at mcode_addr (which cannot be in TCM).
+ */
+struct dma_copy *dma_copy_create(uintptr_t mcode_addr, unsigned channel);
+
+void dma_copy_destroy(struct dma_copy *dc);
+
+/**
+ * Copy with the DMA channel 'arg' (a struct dma_copy).
+ * Returns 0 on success, or non-zero if addresses or size aren't word-aligned
+ * or the transfer failed.
+ */
+int dma_copy(void *dest, const void *src, size_t sz, void *arg);
+
+#endif // DMA_COPY_H
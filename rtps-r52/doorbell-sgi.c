@@ -0,0 +1,93 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+#include <rtems/bspIo.h>
+#include <rtems/irq-extension.h>
+#include <bsp/arm-gic-irq.h>
+
+// libhpsc
+#include <doorbell.h>
+
+#include "doorbell-sgi.h"
+#include "gic.h"
+
+struct doorbell_sgi {
+    rtems_vector_number vec_ring;
+    rtems_vector_number vec_listen;
+    uint8_t cpu_targets;
+};
+
+
+static void doorbell_sgi_ring(struct doorbell *db)
+{
+    struct doorbell_sgi *sdb = db->priv;
+    rtems_status_code sc RTEMS_UNUSED;
+    sc = arm_gic_irq_generate_software_irq(
+        sdb->vec_ring, ARM_GIC_IRQ_SOFTWARE_IRQ_TO_ALL_IN_LIST,
+        sdb->cpu_targets
+    );
+    assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static int doorbell_sgi_close(struct doorbell *db)
+{
+    struct doorbell_sgi *sdb = db->priv;
+    rtems_status_code sc;
+    printk("%s: close\n", db->name);
+    sc = rtems_interrupt_handler_remove(sdb->vec_listen, doorbell_rung, db);
+    free(sdb);
+    free(db);
+    return sc == RTEMS_SUCCESSFUL ? 0 : 1;
+}
+
+struct doorbell *doorbell_sgi_open(const char *name,
+                                   rtems_vector_number vec_ring,
+                                   rtems_vector_number vec_listen,
+                                   uint8_t cpu_targets)
+{
+    struct doorbell_sgi *sdb;
+    struct doorbell *db;
+    rtems_status_code sc;
+    assert(name);
+    assert(vec_ring < GIC_NR_SGIS);
+    assert(vec_listen < GIC_NR_SGIS);
+    assert(cpu_targets);
+
+    printk("%s: open\n", name);
+    printk("\tvec_ring    = %u\n", vec_ring);
+    printk("\tvec_listen  = %u\n", vec_listen);
+    printk("\tcpu_targets = 0x%x\n", cpu_targets);
+    db = malloc(sizeof(*db));
+    if (!db)
+        return NULL;
+    sdb = malloc(sizeof(*sdb));
+    if (!sdb)
+        goto free_db;
+
+    doorbell_init(db, name, sdb);
+    db->ring = doorbell_sgi_ring;
+    db->close = doorbell_sgi_close;
+
+    sdb->vec_ring = vec_ring;
+    sdb->vec_listen = vec_listen;
+    sdb->cpu_targets = cpu_targets;
+
+    sc = rtems_interrupt_handler_install(vec_listen, name,
+                                         RTEMS_INTERRUPT_UNIQUE, doorbell_rung,
+                                         db);
+    if (sc != RTEMS_SUCCESSFUL) {
+        printk("ERROR: doorbell_sgi_open: failed to install handler: %s\n",
+               rtems_status_text(sc));
+        goto free_dbs;
+    }
+
+    return db;
+
+free_dbs:
+    free(sdb);
+free_db:
+    free(db);
+    return NULL;
+}
@@ -0,0 +1,22 @@
+#ifndef DOORBELL_SGI_H
+#define DOORBELL_SGI_H
+
+#include <stdint.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <doorbell.h>
+
+/**
+ * Open a doorbell using GIC Software-Generated Interrupts between R52 cores.
+ * Rings raise SGI vec_ring on the CPUs in the cpu_targets mask.
+ * Rings are received on SGI vec_listen, which is only enabled on the calling
+ * CPU, so pin the calling task to the CPU that the remote targets.
+ */
+struct doorbell *doorbell_sgi_open(const char *name,
+                                   rtems_vector_number vec_ring,
+                                   rtems_vector_number vec_listen,
+                                   uint8_t cpu_targets);
+
+#endif // DOORBELL_SGI_H
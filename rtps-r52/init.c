@@ -1,9 +1,11 @@
 #include <assert.h>
+#include <errno.h>
 #include <sched.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include <rtems.h>
 #include <rtems/shell.h>
@@ -16,24 +18,34 @@
 #include <hpsc-rti-timer.h>
 
 // libhpsc
-#include <affinity.h>
+#include <boot-time.h>
 #include <command.h>
 #include <devices.h>
+#include <doorbell.h>
+#include <doorbell-mbox.h>
+#include <file-xfer.h>
 #include <link.h>
 #include <link-mbox.h>
 #include <link-shmem.h>
 #include <link-store.h>
+#include <mem-access.h>
+#include <prop-store.h>
+#include <task-table.h>
 
 // plat
 #include <mailbox-map.h>
 #include <mem-map.h>
 
+#include "dma-copy.h"
 #include "gic.h"
 #include "link-names.h"
+#include "notify.h"
 #include "server.h"
 #include "shell-tests.h"
 #include "shutdown.h"
+#include "tasks.h"
 #include "test.h"
+#include "test-runner.h"
 #include "watchdog.h"
 
 // Design note:
@@ -41,16 +53,36 @@
 // Incompatible TEST_* options (e.g., missing CONFIG_* dependencies) -> warning.
 
 #define CMD_TIMEOUT_TICKS 10000
+#define CMD_QUEUE_LEN 64
+// workers check in at least twice per period, and the WDT is checked on its
+// kick interval, so a worker is only late if it's stuck on a command
+#define CMD_HEALTH_PERIOD_TICKS RTEMS_MICROSECONDS_TO_TICKS(500000)
+#define CMD_QUEUE_HWM 48
+#define CMD_WORKERS_MAX 2 // one per R52 core
 #define SHMEM_POLL_TICKS 100
+#define MEM_ACCESS_DMA_CHANNEL 1 // channel 0 is used by tests
+#define MEM_ACCESS_DMA_MIN_SIZE 256
+#define FILE_XFER_LOG_DIR "/log"
+#define FILE_XFER_DATA_DIR "/data"
+#define FILE_XFER_UPLOAD_DIR "/tmp"
 
 // lower values are higher priority, in range 1-255
 #define TASK_PRI_WDT 1
 #define TASK_PRI_SHMEM_POLL_TRCH 10
 #define TASK_PRI_CMDH 20
+#define TASK_PRI_FILE_XFER 30
+#define TASK_PRI_TESTS 50
 #define TASK_PRI_SHELL 100
 
 #define NAME_MBOX_TRCH "TRCH-RTPS Mailbox"
 #define NAME_MBOX_HPPS "HPPS-RTPS Mailbox"
+#define NAME_DOORBELL_TRCH "TRCH-RTPS Shmem Doorbell"
+
+#if CONFIG_LINK_SHMEM_TRCH_CACHEABLE
+#define SHMEM_MODE_TRCH SHMEM_MODE_CACHEABLE
+#else
+#define SHMEM_MODE_TRCH SHMEM_MODE_UNCACHED
+#endif
 
 static rtems_status_code init_extra_drivers(
     rtems_device_major_number major,
@@ -58,8 +90,7 @@ static rtems_status_code init_extra_drivers(
     void *arg
 )
 {
-    cpu_set_t cpuset;
-    rtems_status_code sc;
+    rtems_status_code sc RTEMS_UNUSED;
 
 #if CONFIG_MBOX_LSIO
     struct hpsc_mbox *mbox_lsio = NULL;
@@ -78,6 +109,7 @@ static rtems_status_code init_extra_drivers(
     if (sc != RTEMS_SUCCESSFUL)
         rtems_panic(NAME_MBOX_TRCH);
     dev_set_mbox(DEV_ID_MBOX_LSIO, mbox_lsio);
+    boot_time_mark("mbox_lsio");
 #endif // CONFIG_MBOX_LSIO
 
 #if CONFIG_MBOX_HPPS_RTPS
@@ -97,12 +129,10 @@ static rtems_status_code init_extra_drivers(
     if (sc != RTEMS_SUCCESSFUL)
         rtems_panic(NAME_MBOX_HPPS);
     dev_set_mbox(DEV_ID_MBOX_HPPS_RTPS, mbox_hpps);
+    boot_time_mark("mbox_hpps_rtps");
 #endif // CONFIG_MBOX_HPPS_RTPS
 
-    // store CPU affinity before CPU-specific operations
-    sc = rtems_task_get_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
-    assert(sc == RTEMS_SUCCESSFUL);
-
+    // per-CPU devices are set for each CPU without migrating to it
 #if CONFIG_RTI_TIMER
     uintptr_t rtit_bases[] = {
         (uintptr_t) RTI_TIMER_RTPS_R52_0__RTPS_BASE,
@@ -117,13 +147,13 @@ static rtems_status_code init_extra_drivers(
     gic_trigger_set(rtit_vec, GIC_EDGE_TRIGGERED);
     dev_cpu_for_each(rtit_cpu) {
         assert(rtit_cpu < RTEMS_ARRAY_SIZE(rtit_names));
-        affinity_pin_self_to_cpu(rtit_cpu);
         sc = hpsc_rti_timer_probe(&rtit, rtit_names[rtit_cpu],
                                   rtit_bases[rtit_cpu], rtit_vec);
         if (sc != RTEMS_SUCCESSFUL)
             rtems_panic("%s", rtit_names[rtit_cpu]);
-        dev_cpu_set_rtit(rtit);
+        dev_cpu_set_rtit_for(rtit_cpu, rtit);
     }
+    boot_time_mark("rti_timers");
 #endif // CONFIG_RTI_TIMER
 
 #if CONFIG_WDT
@@ -138,43 +168,60 @@ static rtems_status_code init_extra_drivers(
         gic_irq_to_rvn(PPI_IRQ__WDT, GIC_IRQ_TYPE_PPI);
     dev_cpu_for_each(wdt_cpu) {
         assert(wdt_cpu < RTEMS_ARRAY_SIZE(wdt_names));
-        affinity_pin_self_to_cpu(wdt_cpu);
         wdt_init_target(&wdts[wdt_cpu], wdt_names[wdt_cpu], wdt_bases[wdt_cpu],
                         wdt_vec);
-        dev_cpu_set_wdt(&wdts[wdt_cpu]);
+        dev_cpu_set_wdt_for(wdt_cpu, &wdts[wdt_cpu]);
     }
+    boot_time_mark("wdts");
 #endif // CONFIG_WDT
 
-    // restore CPU affinity
-    sc = rtems_task_set_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
-    assert(sc == RTEMS_SUCCESSFUL);
+    boot_time_mark("drivers");
 
     return RTEMS_SUCCESSFUL;
 }
 
-static void standalone_tests(void)
+#if TEST_RTPS_MMU
+static int test_rtps_mmu_only(void)
 {
+    return test_rtps_mmu(false);
+}
+
+#if TEST_RTPS_DMA
+static int test_rtps_mmu_dma(void)
+{
+    return test_rtps_mmu(true);
+}
+#endif // TEST_RTPS_DMA
+#endif // TEST_RTPS_MMU
+
+// Resources that standalone tests use exclusively
+#define TEST_RES_LSIO_SRAM  0x1
+#define TEST_RES_MBOX_LSIO  0x2
+#define TEST_RES_RTI_TIMERS 0x4
+#define TEST_RES_RTPS_MMU   0x8
+#define TEST_RES_DMA        0x10 // the BSP DMA controller
+
+// Independent tests run concurrently, see test_runner_run
+static const struct test_runner_test standalone_test_table[] = {
 #if TEST_COMMAND
-    if (test_command())
-        rtems_panic("Command test");
+    { "command", test_command, 0, { NULL } },
 #endif // TEST_COMMAND
 
 #if TEST_LSIO_SRAM
-    if (test_lsio_sram())
-        rtems_panic("LSIO SRAM test");
+    { "lsio_sram", test_lsio_sram, TEST_RES_LSIO_SRAM, { NULL } },
 #endif // TEST_LSIO_SRAM
 
 #if TEST_LSIO_SRAM_DMA
-    if (test_lsio_sram_dma())
-        rtems_panic("LSIO SRAM w/ DMA test");
+    { "lsio_sram_dma", test_lsio_sram_dma,
+      TEST_RES_LSIO_SRAM | TEST_RES_DMA, { "lsio_sram" } },
 #endif // TEST_LSIO_SRAM_DMA
 
 #if TEST_MBOX_LSIO_LOOPBACK
 #if !CONFIG_MBOX_LSIO
     #warning Ignoring TEST_MBOX_LSIO_LOOPBACK - requires CONFIG_MBOX_LSIO
 #else
-    if (test_mbox_lsio_loopback())
-        rtems_panic("RTPS LSIO mbox loopback test");
+    { "mbox_lsio_loopback", test_mbox_lsio_loopback, TEST_RES_MBOX_LSIO,
+      { NULL } },
 #endif // CONFIG_MBOX_LSIO
 #endif // TEST_MBOX_LSIO_LOOPBACK
 
@@ -182,27 +229,60 @@ static void standalone_tests(void)
 #if !CONFIG_RTI_TIMER
     #warning Ignoring TEST_RTI_TIMER - requires CONFIG_RTI_TIMER
 #else
-    if (test_cpu_rti_timers())
-        rtems_panic("RTI Timer test");
+    { "cpu_rti_timers", test_cpu_rti_timers, TEST_RES_RTI_TIMERS, { NULL } },
 #endif // CONFIG_RTI_TIMER
 #endif // TEST_RTI_TIMER
 
 #if TEST_RTPS_DMA
 #if TEST_RTPS_MMU
-    if (test_rtps_mmu(true))
-        rtems_panic("RTPS MMU+DMA test");
+    { "rtps_mmu_dma", test_rtps_mmu_dma,
+      TEST_RES_RTPS_MMU | TEST_RES_DMA, { NULL } },
 #else
     #warning Ignoring TEST_RTPS_DMA - requires TEST_RTPS_MMU
 #endif // TEST_RTPS_MMU
 #elif TEST_RTPS_MMU
-    if (test_rtps_mmu(false))
-        rtems_panic("RTPS MMU test");
+    { "rtps_mmu", test_rtps_mmu_only, TEST_RES_RTPS_MMU, { NULL } },
 #endif // TEST_RTPS_DMA
 
 #if TEST_SHMEM
-    if (test_shmem())
-        rtems_panic("shmem test");
+    { "shmem", test_shmem, 0, { NULL } },
 #endif // TEST_SHMEM
+
+#if TEST_SHMEM_ARENA
+    { "shmem_arena", test_shmem_arena, 0, { "shmem" } },
+#endif // TEST_SHMEM_ARENA
+
+#if TEST_SHMEM_BCAST
+    { "shmem_bcast", test_shmem_bcast, 0, { "shmem" } },
+#endif // TEST_SHMEM_BCAST
+
+#if TEST_HEALTH
+    { "health", test_health, 0, { NULL } },
+#endif // TEST_HEALTH
+
+#if TEST_MEM_ACCESS
+    { "mem_access", test_mem_access, 0, { NULL } },
+#endif // TEST_MEM_ACCESS
+
+#if TEST_FILE_XFER
+    { "file_xfer", test_file_xfer, 0, { "mem_access" } },
+#endif // TEST_FILE_XFER
+
+#if TEST_PROP_STORE
+    { "prop_store", test_prop_store, 0, { NULL } },
+#endif // TEST_PROP_STORE
+
+#if TEST_TELEMETRY
+    { "telemetry", test_telemetry, 0, { NULL } },
+#endif // TEST_TELEMETRY
+};
+
+static void standalone_tests(void)
+{
+    if (test_runner_run(standalone_test_table,
+                        RTEMS_ARRAY_SIZE(standalone_test_table),
+                        TASK_PRI_TESTS))
+        rtems_panic("Standalone tests");
 }
 
 static void runtime_tests(void)
@@ -216,6 +296,11 @@ static void runtime_tests(void)
     if (test_link_shmem())
         rtems_panic("Shmem link test");
 #endif // TEST_LINK_SHMEM
+
+#if TEST_LINK_SHMEM_DOORBELL
+    if (test_link_shmem_doorbell())
+        rtems_panic("Shmem link with doorbell test");
+#endif // TEST_LINK_SHMEM_DOORBELL
 }
 
 static void external_tests(void)
@@ -239,29 +324,44 @@ static void external_tests(void)
 #endif // TEST_SHMEM_LINK_TRCH
 }
 
-static void init_client_links(void)
-{
-    rtems_status_code sc RTEMS_UNUSED;
-
 #if CONFIG_LINK_MBOX_TRCH_CLIENT
 #if !CONFIG_MBOX_LSIO
     #error CONFIG_LINK_MBOX_TRCH_CLIENT requires CONFIG_MBOX_LSIO
 #endif // CONFIG_MBOX_LSIO
+static struct link *connect_mbox_trch_client(void *arg RTEMS_UNUSED)
+{
     struct hpsc_mbox *mbox_lsio = dev_get_mbox(DEV_ID_MBOX_LSIO);
     assert(mbox_lsio);
-    struct link *tmc_link = link_mbox_connect(LINK_NAME__MBOX__TRCH_CLIENT,
+    return link_mbox_connect(LINK_NAME__MBOX__TRCH_CLIENT,
         mbox_lsio,
         LSIO_MBOX0_CHAN__TRCH_SSW__RTPS_R52_LOCKSTEP_SSW,
-        LSIO_MBOX0_CHAN__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW, 
+        LSIO_MBOX0_CHAN__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW,
         /* server */ 0, /* client */ MASTER_ID_RTPS_CPU0);
-    if (!tmc_link)
-        rtems_panic(LINK_NAME__MBOX__TRCH_CLIENT);
-    link_store_append(tmc_link);
+}
 #endif // CONFIG_LINK_MBOX_TRCH_CLIENT
 
 #if CONFIG_LINK_SHMEM_TRCH_CLIENT
+static struct link *connect_shmem_trch_client(void *arg RTEMS_UNUSED)
+{
+    struct link *link;
+#if CONFIG_LINK_SHMEM_TRCH_DOORBELL
+#if !CONFIG_MBOX_LSIO
+    #error CONFIG_LINK_SHMEM_TRCH_DOORBELL requires CONFIG_MBOX_LSIO
+#endif // CONFIG_MBOX_LSIO
+    rtems_id tsc_tid_recv = RTEMS_ID_NONE;
+    rtems_id tsc_tid_ack = RTEMS_ID_NONE;
+    struct doorbell *tsc_db = doorbell_mbox_open(NAME_DOORBELL_TRCH,
+        dev_get_mbox(DEV_ID_MBOX_LSIO),
+        LSIO_MBOX0_CHAN__TRCH_SSW__RTPS_R52_LOCKSTEP_SSW__DOORBELL,
+        LSIO_MBOX0_CHAN__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW__DOORBELL,
+        /* server */ 0, /* client */ MASTER_ID_RTPS_CPU0);
+    if (!tsc_db)
+        return NULL;
+#else
+    rtems_status_code sc RTEMS_UNUSED;
     rtems_id tsc_tid_recv;
     rtems_id tsc_tid_ack;
+    struct doorbell *tsc_db = NULL;
     rtems_name tsc_tn_recv = rtems_build_name('T', 'S', 'C', 'R');
     rtems_name tsc_tn_ack = rtems_build_name('T', 'S', 'C', 'A');
     sc = rtems_task_create(
@@ -274,16 +374,54 @@ static void init_client_links(void)
         RTEMS_DEFAULT_MODES, RTEMS_DEFAULT_ATTRIBUTES, &tsc_tid_ack
     );
     assert(sc == RTEMS_SUCCESSFUL);
-    struct link *tsc_link = link_shmem_connect(LINK_NAME__SHMEM__TRCH_CLIENT,
+#endif // CONFIG_LINK_SHMEM_TRCH_DOORBELL
+    link = link_shmem_connect(LINK_NAME__SHMEM__TRCH_CLIENT,
         RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW,
-        RTPS_DDR_ADDR__SHM__TRCH_SSW__RTPS_R52_LOCKSTEP_SSW,
-        /* is_server */ false, SHMEM_POLL_TICKS, tsc_tid_recv, tsc_tid_ack);
-    if (!tsc_link)
-        rtems_panic(LINK_NAME__SHMEM__TRCH_CLIENT);
-    link_store_append(tsc_link);
+        RTPS_DDR_ADDR__SHM__TRCH_SSW__RTPS_R52_LOCKSTEP_SSW, SHMEM_MODE_TRCH,
+        /* is_server */ false, SHMEM_POLL_TICKS, tsc_tid_recv, tsc_tid_ack,
+        tsc_db);
+    if (!link) {
+        // still ours, so a later connect may retry
+#if CONFIG_LINK_SHMEM_TRCH_DOORBELL
+        doorbell_close(tsc_db);
+#else
+        rtems_task_delete(tsc_tid_ack);
+        rtems_task_delete(tsc_tid_recv);
+#endif // CONFIG_LINK_SHMEM_TRCH_DOORBELL
+    }
+    return link;
+}
+#endif // CONFIG_LINK_SHMEM_TRCH_CLIENT
+
+// Client links are only used by requests we make, so may connect on first use
+static void init_client_link(const char *name, link_store_connect_fn connect)
+{
+    rtems_status_code sc;
+#if CONFIG_LINK_LAZY_CLIENTS
+    sc = link_store_append_lazy(name, connect, NULL);
+#else
+    struct link *link = connect(NULL);
+    if (!link)
+        rtems_panic("%s", name);
+    sc = link_store_append(link);
+#endif // CONFIG_LINK_LAZY_CLIENTS
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("%s: link store append", name);
+}
+
+static void init_client_links(void)
+{
+#if CONFIG_LINK_MBOX_TRCH_CLIENT
+    init_client_link(LINK_NAME__MBOX__TRCH_CLIENT, connect_mbox_trch_client);
+#endif // CONFIG_LINK_MBOX_TRCH_CLIENT
+
+#if CONFIG_LINK_SHMEM_TRCH_CLIENT
+    init_client_link(LINK_NAME__SHMEM__TRCH_CLIENT, connect_shmem_trch_client);
 #endif // CONFIG_LINK_SHMEM_TRCH_CLIENT
 }
 
+// Server links stay connected from boot: a remote's first request can't be
+// noticed before the link claims its channels.
 static void init_server_links(void)
 {
     rtems_status_code sc RTEMS_UNUSED;
@@ -306,8 +444,9 @@ static void init_server_links(void)
 //     assert(sc == RTEMS_SUCCESSFUL);
 //     struct link *tss_link = link_shmem_connect(LINK_NAME__SHMEM__TRCH_SERVER,
 //         RTPS_DDR_ADDR__SHM__TRCH_SSW__RTPS_R52_LOCKSTEP_SSW,
-//         RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW,
-//         /* is_server */ true, SHMEM_POLL_TICKS, tss_tid_recv, tss_tid_ack);
+//         RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP_SSW__TRCH_SSW, SHMEM_MODE_TRCH,
+//         /* is_server */ true, SHMEM_POLL_TICKS, tss_tid_recv, tss_tid_ack,
+//         NULL);
 //     if (!tss_link)
 //         rtems_panic(LINK_NAME__SHMEM__TRCH_SERVER);
 //     link_store_append(tss_link);
@@ -330,22 +469,164 @@ static void init_server_links(void)
 #endif // CONFIG_LINK_MBOX_HPPS_SERVER
 }
 
-static void early_tasks(void)
+static void init_notify(void)
+{
+#if CONFIG_SHMEM_BCAST
+    rtems_status_code sc = notify_init(
+        RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP_SSW__BCAST,
+        RTPS_DDR_SIZE__SHM__RTPS_R52_LOCKSTEP_SSW__BCAST);
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("notify init");
+#endif // CONFIG_SHMEM_BCAST
+}
+
+static void init_mem_access(void)
 {
-    rtems_name task_name;
-    rtems_id task_id;
+#if CONFIG_MEM_ACCESS
     rtems_status_code sc;
+#if CONFIG_MEM_ACCESS_DMA
+    struct dma_copy *dc;
+#endif // CONFIG_MEM_ACCESS_DMA
+    // messaging state may be inspected, but not modified
+    sc = mem_access_allow(RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP,
+                          RTPS_DDR_SIZE__SHM__RTPS_R52_LOCKSTEP,
+                          MEM_ACCESS_READ);
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("mem access allow shm");
+    // for bulk transfer buffers and data collection
+    sc = mem_access_allow(RTPS_DDR_ADDR__SHM__RTPS_R52_LOCKSTEP__FREE,
+                          RTPS_DDR_SIZE__SHM__RTPS_R52_LOCKSTEP__FREE,
+                          MEM_ACCESS_READ | MEM_ACCESS_WRITE);
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("mem access allow shm free");
+#if CONFIG_MEM_ACCESS_DMA
+    dc = dma_copy_create(RTPS_DMA_MCODE_ADDR__MEM_ACCESS,
+                         MEM_ACCESS_DMA_CHANNEL);
+    if (!dc)
+        rtems_panic("mem access DMA");
+    mem_access_set_bulk_copy(dma_copy, dc, MEM_ACCESS_DMA_MIN_SIZE);
+#endif // CONFIG_MEM_ACCESS_DMA
+#endif // CONFIG_MEM_ACCESS
+}
 
-    // command queue handler task
-    task_name = rtems_build_name('C','M','D','H');
-    sc = rtems_task_create(
-        task_name, TASK_PRI_CMDH, RTEMS_MINIMUM_STACK_SIZE,
-        RTEMS_DEFAULT_MODES, RTEMS_DEFAULT_ATTRIBUTES, &task_id
-    );
-    assert(sc == RTEMS_SUCCESSFUL);
-    sc = cmd_handle_task_start(task_id, server_process, CMD_TIMEOUT_TICKS);
+static void init_props(void)
+{
+    // configuration, for remotes to query with READ_PROP
+    rtems_status_code sc;
+    sc = prop_store_register(hpsc_msg_prop_id("rtps.cpus"), PROP_TYPE_U32, 0,
+                             rtems_get_processor_count());
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("prop register");
+    sc = prop_store_register(hpsc_msg_prop_id("rtps.ticks_per_second"),
+                             PROP_TYPE_U32, 0,
+                             rtems_clock_get_ticks_per_second());
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("prop register");
+    sc = prop_store_register(hpsc_msg_prop_id("rtps.cmd.queue_len"),
+                             PROP_TYPE_U32, 0, CMD_QUEUE_LEN);
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("prop register");
+}
+
+#if CONFIG_FILE_XFER
+static void init_file_xfer_root(const char *path, unsigned perms)
+{
+    rtems_status_code sc;
+    if (mkdir(path, 0755) && errno != EEXIST)
+        rtems_panic("file xfer mkdir: %s", path);
+    sc = file_xfer_allow(path, perms);
+    if (sc != RTEMS_SUCCESSFUL)
+        rtems_panic("file xfer allow: %s", path);
+}
+#endif // CONFIG_FILE_XFER
+
+static void init_file_xfer(void)
+{
+#if CONFIG_FILE_XFER
+    // logs and data may be pulled, but only uploaded to one place
+    init_file_xfer_root(FILE_XFER_LOG_DIR, FILE_XFER_READ);
+    init_file_xfer_root(FILE_XFER_DATA_DIR, FILE_XFER_READ);
+    init_file_xfer_root(FILE_XFER_UPLOAD_DIR,
+                        FILE_XFER_READ | FILE_XFER_WRITE);
+#if CONFIG_FILE_XFER_READ_ALL
+    if (file_xfer_allow("/", FILE_XFER_READ) != RTEMS_SUCCESSFUL)
+        rtems_panic("file xfer allow: /");
+#endif // CONFIG_FILE_XFER_READ_ALL
+#endif // CONFIG_FILE_XFER
+}
+
+static rtems_status_code cmd_tasks_start(const rtems_id *task_ids,
+                                         uint32_t num_tasks)
+{
+    struct cmd_server *cmd_server;
+    rtems_status_code sc RTEMS_UNUSED;
+    uint32_t cpu RTEMS_UNUSED;
+
+    // command server for all links, with a handler task per CPU
+    cmd_server = cmd_server_create(num_tasks, CMD_QUEUE_LEN, CMD_QUEUE_HWM);
+    if (!cmd_server)
+        return RTEMS_NO_MEMORY;
+    server_init(cmd_server);
+    cmd_server_set_default(cmd_server);
+#if CONFIG_WDT
+    // a stuck worker stops its CPU's WDT from being kicked
+    for (cpu = 0; cpu < num_tasks; cpu++) {
+        sc = cmd_set_health(cmd_server, cpu, watchdog_health(cpu),
+                            CMD_HEALTH_PERIOD_TICKS);
+        assert(sc == RTEMS_SUCCESSFUL);
+    }
+#endif // CONFIG_WDT
+    return cmd_handle_tasks_start(cmd_server, task_ids, server_process,
+                                  CMD_TIMEOUT_TICKS);
+}
+
+static rtems_status_code cmd_tasks_stop(void)
+{
+    return cmd_handle_tasks_destroy(cmd_server_get_default());
+}
+
+#if CONFIG_FILE_XFER
+static rtems_status_code file_xfer_tasks_start(const rtems_id *task_ids,
+                                               uint32_t num_tasks)
+{
+    assert(num_tasks == 1);
+    return file_xfer_task_start(task_ids[0]);
+}
+#endif // CONFIG_FILE_XFER
+
+struct task_spec early_task_table[] = {
+    {
+        .desc = "command handlers",
+        .name = rtems_build_name('C','M','D',0),
+        .priority = TASK_PRI_CMDH,
+        .stack_size = RTEMS_MINIMUM_STACK_SIZE,
+        .instances = CMD_WORKERS_MAX,
+        .per_cpu = true,
+        .pin = CONFIG_CMD_WORKERS_PIN,
+        .start = cmd_tasks_start,
+        .stop = cmd_tasks_stop
+    },
+#if CONFIG_FILE_XFER
+    {
+        // reads ahead while command handlers wait for more chunk requests
+        .desc = "file transfer read-ahead",
+        .name = rtems_build_name('F','X','R','A'),
+        .priority = TASK_PRI_FILE_XFER,
+        .stack_size = RTEMS_MINIMUM_STACK_SIZE,
+        .instances = 1,
+        .start = file_xfer_tasks_start,
+        .stop = file_xfer_task_destroy
+    },
+#endif // CONFIG_FILE_XFER
+};
+const size_t early_task_table_len = RTEMS_ARRAY_SIZE(early_task_table);
+
+static void early_tasks(void)
+{
+    rtems_status_code sc;
+    sc = task_table_start(early_task_table, early_task_table_len);
     if (sc != RTEMS_SUCCESSFUL)
-        rtems_panic("command handler task start");
+        rtems_panic("early tasks start");
 }
 
 static void init_tasks(void)
@@ -377,6 +658,68 @@ static void late_tasks(void)
 #endif // CONFIG_SHELL
 }
 
+// The last mark of each boot phase reported in the LIFECYCLE UP event, in the
+// order of its fields (see telemetry.h)
+static const char *const lifecycle_boot_marks[] = {
+    "drivers",
+    "standalone_tests",
+    "props", // services
+    "early_tasks",
+    "runtime_tests",
+    "server_links", // links
+    "init_tasks",
+    "external_tests",
+    "late_tasks"
+};
+
+static void notify_up(void)
+{
+    uint32_t fields[RTEMS_ARRAY_SIZE(lifecycle_boot_marks)];
+    size_t i;
+    for (i = 0; i < RTEMS_ARRAY_SIZE(lifecycle_boot_marks); i++)
+        fields[i] = boot_time_us(lifecycle_boot_marks[i]);
+    notify_lifecycle(LIFECYCLE_UP, TELEMETRY_STR_RTPS_R52, fields,
+                     RTEMS_ARRAY_SIZE(fields));
+}
+
+static int boot_time_print_command(int argc RTEMS_UNUSED,
+                                   char *argv[] RTEMS_UNUSED)
+{
+    boot_time_print();
+    return 0;
+}
+
+static rtems_shell_cmd_t boot_time_command = {
+    "boottime",                                /* name */
+    "boottime",                                /* usage */
+    "hpsc-rtps-r52",                           /* topic */
+    boot_time_print_command,                   /* command */
+    NULL,                                      /* alias */
+    NULL,                                      /* next */
+    0,                                         /* mode */
+    0,                                         /* uid */
+    0                                          /* gid */
+};
+
+static int task_stats_print_command(int argc RTEMS_UNUSED,
+                                    char *argv[] RTEMS_UNUSED)
+{
+    task_table_print_stats(early_task_table, early_task_table_len);
+    return 0;
+}
+
+static rtems_shell_cmd_t task_stats_command = {
+    "taskstats",                               /* name */
+    "taskstats",                               /* usage */
+    "hpsc-rtps-r52",                           /* topic */
+    task_stats_print_command,                  /* command */
+    NULL,                                      /* alias */
+    NULL,                                      /* next */
+    0,                                         /* mode */
+    0,                                         /* uid */
+    0                                          /* gid */
+};
+
 void *POSIX_Init(void *arg)
 {
     // device drivers already initialized
@@ -384,25 +727,52 @@ void *POSIX_Init(void *arg)
 
     // run boot tests
     standalone_tests();
+    boot_time_mark("standalone_tests");
+
+    // broadcast notifications to other subsystems
+    init_notify();
+    boot_time_mark("notify");
+
+    // remote memory reads and writes
+    init_mem_access();
+    boot_time_mark("mem_access");
+
+    // remote file transfers
+    init_file_xfer();
+    boot_time_mark("file_xfer");
+
+    // remotely queryable properties
+    init_props();
+    boot_time_mark("props");
 
     // start early tasks
     early_tasks();
+    boot_time_mark("early_tasks");
 
     // run tests that require early tasks
     runtime_tests();
+    boot_time_mark("runtime_tests");
 
     // initialize links
     init_client_links();
+    boot_time_mark("client_links");
     init_server_links();
+    boot_time_mark("server_links");
 
     // start basic tasks
     init_tasks();
+    boot_time_mark("init_tasks");
 
     // run tests that require external interaction
     external_tests();
+    boot_time_mark("external_tests");
 
     // start remaining tasks
     late_tasks();
+    boot_time_mark("late_tasks");
+
+    boot_time_print();
+    notify_up();
 
     // init task is finished
     rtems_task_exit();
@@ -415,15 +785,15 @@ void *POSIX_Init(void *arg)
 #define CONFIGURE_SHELL_COMMANDS_INIT
 #define CONFIGURE_SHELL_COMMANDS_ALL
 #define CONFIGURE_SHELL_NO_COMMAND_SHUTDOWN // we override
-// TODO: test_command requires changing state in lib/hpsc/command.c, which by
-//       runtime is already reserved by the application. State would have be
-//       moved out of static structs in command.c and managed by application
-//       before we could enable this test at runtime.
 #define CONFIGURE_SHELL_USER_COMMANDS \
     /* functionality commands */ \
     &shutdown_rtps_r52_command, \
+    &server_cmdlat_command, \
+    &watchdog_health_command, \
+    &boot_time_command, \
+    &task_stats_command, \
     /* standalone tests */ \
-    /* &shell_cmd_test_command, */ \
+    &shell_cmd_test_command, \
     &shell_cmd_test_cpu_rti_timers, \
     &shell_cmd_test_lsio_sram, \
     &shell_cmd_test_lsio_sram_dma, \
@@ -431,9 +801,17 @@ void *POSIX_Init(void *arg)
     &shell_cmd_test_rtps_mmu, \
     &shell_cmd_test_rtps_mmu_dma, \
     &shell_cmd_test_shmem, \
+    &shell_cmd_test_shmem_arena, \
+    &shell_cmd_test_shmem_bcast, \
+    &shell_cmd_test_mem_access, \
+    &shell_cmd_test_file_xfer, \
+    &shell_cmd_test_prop_store, \
+    &shell_cmd_test_telemetry, \
+    &shell_cmd_test_health, \
     /* runtime tests */ \
     &shell_cmd_test_command_server, \
     &shell_cmd_test_link_shmem, \
+    &shell_cmd_test_link_shmem_doorbell, \
     /* externally-dependent tests */ \
     &shell_cmd_test_link_mbox_trch, \
     &shell_cmd_test_link_shmem_trch, \
@@ -462,6 +840,11 @@ void *POSIX_Init(void *arg)
 
 #define CONFIGURE_MAXIMUM_TASKS                    rtems_resource_unlimited (10)
 
+/* per-task stack high-water marks, see the stackuse (and cpuuse) commands */
+#if CONFIG_STACK_CHECKER
+#define CONFIGURE_STACK_CHECKER_ENABLED
+#endif
+
 /* for MMU */
 #define CONFIGURE_MAXIMUM_REGIONS                   1
 
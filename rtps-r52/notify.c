@@ -0,0 +1,48 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <hpsc-msg.h>
+#include <shmem-bcast.h>
+#include <telemetry.h>
+
+#include "notify.h"
+
+static struct shmem_bcast *bcast = NULL;
+
+rtems_status_code notify_init(uintptr_t addr, size_t size)
+{
+    assert(!bcast);
+    bcast = shmem_bcast_create(addr, size, NULL);
+    return bcast ? RTEMS_SUCCESSFUL : RTEMS_UNSATISFIED;
+}
+
+void notify_lifecycle(enum hpsc_msg_lifecycle_status status,
+                      enum telemetry_str info, const uint32_t *fields,
+                      unsigned nfields)
+{
+    HPSC_MSG_DEFINE(msg);
+    uint32_t all_fields[HPSC_MSG_TELEMETRY_FIELDS_MAX];
+    unsigned i;
+    assert(nfields < HPSC_MSG_TELEMETRY_FIELDS_MAX);
+    if (!bcast)
+        return;
+    all_fields[0] = rtems_clock_get_ticks_since_boot();
+    for (i = 0; i < nfields; i++)
+        all_fields[i + 1] = fields[i];
+    hpsc_msg_telemetry(msg, sizeof(msg), TELEMETRY_EVENT_LIFECYCLE, status,
+                       info, all_fields, nfields + 1);
+    shmem_bcast_publish(bcast, msg, sizeof(msg));
+}
+
+void notify_wdt_timeout(unsigned int cpu)
+{
+    HPSC_MSG_DEFINE(msg);
+    if (!bcast)
+        return;
+    hpsc_msg_wdt_timeout(msg, sizeof(msg), cpu);
+    shmem_bcast_publish(bcast, msg, sizeof(msg));
+}
@@ -0,0 +1,28 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <hpsc-msg.h>
+#include <telemetry.h>
+
+// Notifications are published once to a broadcast channel that any number of
+// subsystems read at their own pace. Until the channel is initialized, they are
+// dropped.
+
+rtems_status_code notify_init(uintptr_t addr, size_t size);
+
+// Published as a binary TELEMETRY lifecycle event, with the uptime followed by
+// up to HPSC_MSG_TELEMETRY_FIELDS_MAX - 1 fields (see telemetry.h)
+void notify_lifecycle(enum hpsc_msg_lifecycle_status status,
+                      enum telemetry_str info, const uint32_t *fields,
+                      unsigned nfields);
+
+// May be called from an interrupt context
+void notify_wdt_timeout(unsigned int cpu);
+
+#endif // NOTIFY_H
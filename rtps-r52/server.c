@@ -1,27 +1,169 @@
+#include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/bspIo.h>
+#include <rtems/shell.h>
 
 // libhpsc
 #include <command.h>
+#include <file-xfer.h>
+#include <latency.h>
+#include <link.h>
+#include <link-store.h>
+#include <mem-access.h>
+#include <prop-store.h>
 
 #include "server.h"
 
+static uint32_t prop_pings;
+
+static ssize_t server_nop(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    // do nothing and reply nothing command
+    return 0;
+}
+
+// may run in an interrupt context
+static ssize_t server_ping(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    const struct hpsc_msg_ping_payload *ping = hpsc_msg_ping_decode(cmd->msg);
+    printk("PING ...\n");
+    assert(ping);
+    assert(reply_sz == HPSC_MSG_SIZE);
+    prop_store_add(prop_pings, 1);
+    // echo straight into the reply buffer
+    memcpy(hpsc_msg_pong_encode(reply)->data, ping->data, sizeof(ping->data));
+    return reply_sz;
+}
+
+static ssize_t server_pong(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    printf("PONG ...\n");
+    return 0;
+}
+
+static ssize_t server_read_addr(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    return mem_access_read_addr(cmd->msg, reply, reply_sz);
+}
+
+static ssize_t server_write_addr(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    return mem_access_write_addr(cmd->msg, reply, reply_sz);
+}
+
+// may run in an interrupt context
+static ssize_t server_read_prop(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    return prop_store_read_prop(cmd->msg, reply, reply_sz);
+}
+
+// may run in an interrupt context
+static ssize_t server_write_prop(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    return prop_store_write_prop(cmd->msg, reply, reply_sz);
+}
+
+static ssize_t server_read_file(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    return file_xfer_read_file(cmd->link, cmd->msg, reply, reply_sz);
+}
+
+static ssize_t server_write_file(struct cmd *cmd, void *reply, size_t reply_sz)
+{
+    return file_xfer_write_file(cmd->link, cmd->msg, reply, reply_sz);
+}
+
+void server_init(struct cmd_server *s)
+{
+    rtems_status_code sc RTEMS_UNUSED;
+    prop_pings = hpsc_msg_prop_id("rtps.server.pings");
+    sc = prop_store_register(prop_pings, PROP_TYPE_U32, 0, 0);
+    assert(sc == RTEMS_SUCCESSFUL);
+    // health checks are answered on receipt, regardless of command backlog
+    sc = cmd_register(s, NOP, server_nop, CMD_FLAG_ISR_SAFE);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = cmd_register(s, PING, server_ping,
+                      CMD_FLAG_REPLY_EXPECTED | CMD_FLAG_ISR_SAFE);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = cmd_register(s, PONG, server_pong, 0);
+    assert(sc == RTEMS_SUCCESSFUL);
+    // bulk copies may take a while, so are served by workers
+    sc = cmd_register(s, READ_ADDR, server_read_addr, CMD_FLAG_REPLY_EXPECTED);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = cmd_register(s, WRITE_ADDR, server_write_addr,
+                      CMD_FLAG_REPLY_EXPECTED);
+    assert(sc == RTEMS_SUCCESSFUL);
+    // property lookups are lock-free, so are answered on receipt too
+    sc = cmd_register(s, READ_PROP, server_read_prop,
+                      CMD_FLAG_REPLY_EXPECTED | CMD_FLAG_ISR_SAFE);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = cmd_register(s, WRITE_PROP, server_write_prop,
+                      CMD_FLAG_REPLY_EXPECTED | CMD_FLAG_ISR_SAFE);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = cmd_register(s, READ_FILE, server_read_file, CMD_FLAG_REPLY_EXPECTED);
+    assert(sc == RTEMS_SUCCESSFUL);
+    sc = cmd_register(s, WRITE_FILE, server_write_file,
+                      CMD_FLAG_REPLY_EXPECTED);
+    assert(sc == RTEMS_SUCCESSFUL);
+}
+
 ssize_t server_process(struct cmd *cmd, void *reply, size_t reply_sz)
 {
-    switch (cmd->msg[0]) {
-        case NOP:
-            // do nothing and reply nothing command
-            return 0;
-        case PING:
-            printf("PING ...\n");
-            hpsc_msg_pong(reply, reply_sz, &cmd->msg[HPSC_MSG_PAYLOAD_OFFSET],
-                          HPSC_MSG_PAYLOAD_SIZE);
-            return reply_sz;
-        case PONG:
-            printf("PONG ...\n");
-            return 0;
-        default:
-            printf("ERROR: unknown cmd: %x\n", cmd->msg[0]);
-            return -1;
+    printf("ERROR: unknown cmd: %x\n", hpsc_msg_type(cmd->msg));
+    return -1;
+}
+
+static int server_cmdlat(int argc, char *argv[])
+{
+    struct cmd_server *s = cmd_server_get_default();
+    struct cmd_latency lat;
+    struct link *link;
+    unsigned type;
+    unsigned i;
+    if (!s) {
+        printf("No command server\n");
+        return 1;
     }
+    if (argc == 2 && !strcmp(argv[1], "reset")) {
+        cmd_reset_stats(s);
+        return 0;
+    }
+    if (argc == 2) {
+        // don't connect a lazy link just to look at it
+        link = link_store_peek(argv[1]);
+        if (!link) {
+            if (link_store_contains(argv[1]))
+                printf("Link not connected: %s\n", argv[1]);
+            else
+                printf("No such link: %s\n", argv[1]);
+            return 1;
+        }
+        latency_hist_print(&link->cmd_latency, link->name);
+        return 0;
+    }
+    for (type = 0; type < HPSC_MSG_TYPE_COUNT; type++) {
+        cmd_get_latency(s, type, &lat);
+        if (!lat.stage[CMD_LATENCY_TOTAL].count)
+            continue;
+        printf("cmd %u:\n", type);
+        for (i = 0; i < CMD_TS_COUNT; i++)
+            latency_hist_print(&lat.stage[i], cmd_latency_stage_name(i));
+    }
+    return 0;
 }
+
+rtems_shell_cmd_t server_cmdlat_command = {
+    "cmdlat",                                  /* name */
+    "cmdlat [<link name> | reset]",            /* usage */
+    "hpsc-rtps-r52",                           /* topic */
+    server_cmdlat,                             /* command */
+    NULL,                                      /* alias */
+    NULL,                                      /* next */
+    0,                                         /* mode */
+    0,                                         /* uid */
+    0                                          /* gid */
+};
@@ -4,10 +4,19 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include <rtems/shell.h>
+
 // libhpsc
 #include <command.h>
 
-// Compatible with cmd_handler_t function
+// Register handlers for the message types we serve
+void server_init(struct cmd_server *s);
+
+// Compatible with cmd_handler_t function, for unregistered message types
 ssize_t server_process(struct cmd *cmd, void *reply, size_t reply_sz);
 
+// Shell command to print the command latency histograms, per message type or
+// for one link
+extern rtems_shell_cmd_t server_cmdlat_command;
+
 #endif // SERVER_H
@@ -28,7 +28,10 @@ rtems_shell_cmd_t shell_cmd_test_command = {
 static int shell_test_cpu_rti_timers(int argc RTEMS_UNUSED,
                                      char *argv[] RTEMS_UNUSED)
 {
-#if CONFIG_RTI_TIMER
+#if CONFIG_WDT && CONFIG_WDT_KICK_RTIT
+    fprintf(stderr, "ERROR: RTI timers are in use kicking the watchdogs!\n");
+    return -1;
+#elif CONFIG_RTI_TIMER
     return test_cpu_rti_timers();
 #else 
     fprintf(stderr, "ERROR: CONFIG_RTI_TIMER is not set!\n");
@@ -131,6 +134,103 @@ rtems_shell_cmd_t shell_cmd_test_shmem = {
     0, 0, 0                                    /* mode, uid, gid */
 };
 
+static int shell_test_shmem_arena(int argc RTEMS_UNUSED,
+                                  char *argv[] RTEMS_UNUSED)
+{
+    return test_shmem_arena();
+}
+rtems_shell_cmd_t shell_cmd_test_shmem_arena = {
+    "test_shmem_arena",                        /* name */
+    "test_shmem_arena",                        /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_shmem_arena,                    /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
+static int shell_test_shmem_bcast(int argc RTEMS_UNUSED,
+                                  char *argv[] RTEMS_UNUSED)
+{
+    return test_shmem_bcast();
+}
+rtems_shell_cmd_t shell_cmd_test_shmem_bcast = {
+    "test_shmem_bcast",                        /* name */
+    "test_shmem_bcast",                        /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_shmem_bcast,                    /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
+static int shell_test_mem_access(int argc RTEMS_UNUSED,
+                                 char *argv[] RTEMS_UNUSED)
+{
+    return test_mem_access();
+}
+rtems_shell_cmd_t shell_cmd_test_mem_access = {
+    "test_mem_access",                         /* name */
+    "test_mem_access",                         /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_mem_access,                     /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
+static int shell_test_file_xfer(int argc RTEMS_UNUSED,
+                                char *argv[] RTEMS_UNUSED)
+{
+    return test_file_xfer();
+}
+rtems_shell_cmd_t shell_cmd_test_file_xfer = {
+    "test_file_xfer",                          /* name */
+    "test_file_xfer",                          /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_file_xfer,                      /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
+static int shell_test_prop_store(int argc RTEMS_UNUSED,
+                                 char *argv[] RTEMS_UNUSED)
+{
+    return test_prop_store();
+}
+rtems_shell_cmd_t shell_cmd_test_prop_store = {
+    "test_prop_store",                         /* name */
+    "test_prop_store",                         /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_prop_store,                     /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
+static int shell_test_telemetry(int argc RTEMS_UNUSED,
+                                char *argv[] RTEMS_UNUSED)
+{
+    return test_telemetry();
+}
+rtems_shell_cmd_t shell_cmd_test_telemetry = {
+    "test_telemetry",                          /* name */
+    "test_telemetry",                          /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_telemetry,                      /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
+static int shell_test_health(int argc RTEMS_UNUSED, char *argv[] RTEMS_UNUSED)
+{
+    return test_health();
+}
+rtems_shell_cmd_t shell_cmd_test_health = {
+    "test_health",                             /* name */
+    "test_health",                             /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_health,                         /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
 /******************************************************************************/
 // Local runtime
 /******************************************************************************/
@@ -163,6 +263,20 @@ rtems_shell_cmd_t shell_cmd_test_link_shmem = {
     0, 0, 0                                    /* mode, uid, gid */
 };
 
+static int shell_test_link_shmem_doorbell(int argc RTEMS_UNUSED,
+                                          char *argv[] RTEMS_UNUSED)
+{
+    return test_link_shmem_doorbell();
+}
+rtems_shell_cmd_t shell_cmd_test_link_shmem_doorbell = {
+    "test_link_shmem_doorbell",                /* name */
+    "test_link_shmem_doorbell",                /* usage */
+    SHELL_TESTS_TOPIC,                         /* topic */
+    shell_test_link_shmem_doorbell,            /* command */
+    NULL, NULL,                                /* alias, next */
+    0, 0, 0                                    /* mode, uid, gid */
+};
+
 /******************************************************************************/
 // Externally dependent
 /******************************************************************************/
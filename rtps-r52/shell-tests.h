@@ -15,10 +15,18 @@ extern rtems_shell_cmd_t shell_cmd_test_mbox_lsio_loopback;
 extern rtems_shell_cmd_t shell_cmd_test_rtps_mmu;
 extern rtems_shell_cmd_t shell_cmd_test_rtps_mmu_dma;
 extern rtems_shell_cmd_t shell_cmd_test_shmem;
+extern rtems_shell_cmd_t shell_cmd_test_shmem_arena;
+extern rtems_shell_cmd_t shell_cmd_test_shmem_bcast;
+extern rtems_shell_cmd_t shell_cmd_test_mem_access;
+extern rtems_shell_cmd_t shell_cmd_test_file_xfer;
+extern rtems_shell_cmd_t shell_cmd_test_prop_store;
+extern rtems_shell_cmd_t shell_cmd_test_telemetry;
+extern rtems_shell_cmd_t shell_cmd_test_health;
 
 // Local runtime
 extern rtems_shell_cmd_t shell_cmd_test_command_server;
 extern rtems_shell_cmd_t shell_cmd_test_link_shmem;
+extern rtems_shell_cmd_t shell_cmd_test_link_shmem_doorbell;
 
 // Externally dependent
 extern rtems_shell_cmd_t shell_cmd_test_link_mbox_trch;
@@ -13,13 +13,14 @@
 #include <hpsc-rti-timer.h>
 
 // libhpsc
-#include <affinity.h>
 #include <command.h>
 #include <devices.h>
 #include <link.h>
 #include <link-store.h>
 
+#include "notify.h"
 #include "shutdown.h"
+#include "tasks.h"
 #include "watchdog.h"
 
 
@@ -59,6 +60,7 @@ static bool shutdown_task_visitor(rtems_tcb *tcb, void *arg)
 
 RTEMS_NO_RETURN void shutdown(void)
 {
+    struct cmd_server *cmd_server = cmd_server_get_default();
     struct link *link;
     const char *name;
     struct hpsc_rti_timer *rtit;
@@ -68,11 +70,11 @@ RTEMS_NO_RETURN void shutdown(void)
     size_t i;
     uint32_t cpu;
 
-    // try to stop gracefully
-    printf("Stopping command handler...\n");
-    sc = cmd_handle_task_destroy();
-    if (sc != RTEMS_SUCCESSFUL)
-        printf("Failed to stop command handler\n");
+    // tell everyone at once, readers don't acknowledge
+    notify_lifecycle(LIFECYCLE_DOWN, TELEMETRY_STR_RTPS_R52_SHUTDOWN, NULL, 0);
+
+    // try to stop gracefully, e.g., command handlers and file transfers
+    task_table_stop(early_task_table, early_task_table_len);
 
     // NOTE: stop any other tasks with handles on links before continuing
 
@@ -86,10 +88,10 @@ RTEMS_NO_RETURN void shutdown(void)
 
     // Empty the command queue which may now have stale link references.
     // This is done _after_ destroying links because links may have received and
-    // enqueued messages after we stopped the command handler task, and we can't
-    // destroy the links _before_ stopping the command handler task.
+    // enqueued messages after we stopped the command handler tasks, and we
+    // can't destroy the links _before_ stopping the command handler tasks.
     printf("Dropping pending commands...\n");
-    i = cmd_drop_all();
+    i = cmd_drop_all(cmd_server);
     printf("Dropped: %zu\n", i);
 
     // stop kicking watchdogs
@@ -111,17 +113,12 @@ RTEMS_NO_RETURN void shutdown(void)
         }
     }
 
-    // From here on we change our CPU affinity, but we don't really need to
-    // save/restore it since we're shutting down...
-    // TODO: may not be able to bind to all CPUs if task's cpuset disallows it
-
     // disable timers
     printf("Removing RTI timers...\n");
     dev_cpu_for_each(cpu) {
-        affinity_pin_self_to_cpu(cpu);
-        rtit = dev_cpu_get_rtit();
+        rtit = dev_cpu_get_rtit_for(cpu);
         if (rtit) {
-            dev_cpu_set_rtit(NULL);
+            dev_cpu_set_rtit_for(cpu, NULL);
             sc = hpsc_rti_timer_remove(rtit);
             if (sc != RTEMS_SUCCESSFUL)
                 rtems_panic("shutdown: hpsc_rti_timer_remove");
@@ -131,10 +128,9 @@ RTEMS_NO_RETURN void shutdown(void)
     // stop kicking watchdogs
     printf("Removing watchdogs...\n");
     dev_cpu_for_each(cpu) {
-        affinity_pin_self_to_cpu(cpu);
-        wdt = dev_cpu_get_wdt();
+        wdt = dev_cpu_get_wdt_for(cpu);
         if (wdt) {
-            dev_cpu_set_wdt(NULL);
+            dev_cpu_set_wdt_for(cpu, NULL);
             wdt_uninit(wdt);
         }
     }
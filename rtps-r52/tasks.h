@@ -0,0 +1,14 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <stdlib.h>
+
+// libhpsc
+#include <task-table.h>
+
+// Tasks started before links are initialized, in order, so shutdown stops them
+// in reverse before disconnecting links.
+extern struct task_spec early_task_table[];
+extern const size_t early_task_table_len;
+
+#endif // TASKS_H
@@ -0,0 +1,267 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/bspIo.h>
+
+// libhpsc
+#include <affinity.h>
+
+#include "test-runner.h"
+
+// high events, so they don't collide with those the tests wait for
+#define TEST_RUNNER_EVENT_RUN  RTEMS_EVENT_30
+#define TEST_RUNNER_EVENT_EXIT RTEMS_EVENT_31
+#define TEST_RUNNER_EVENT_DONE RTEMS_EVENT_31 // to the runner
+
+enum test_state {
+    TEST_STATE_PENDING = 0,
+    TEST_STATE_RUNNING,
+    TEST_STATE_PASSED,
+    TEST_STATE_FAILED,
+    TEST_STATE_SKIPPED
+};
+
+static const char *const test_state_strs[] = {
+    [TEST_STATE_PENDING] = "pending",
+    [TEST_STATE_RUNNING] = "running",
+    [TEST_STATE_PASSED] = "success",
+    [TEST_STATE_FAILED] = "failed",
+    [TEST_STATE_SKIPPED] = "skipped"
+};
+
+struct test_runner;
+
+struct test_worker {
+    struct test_runner *runner;
+    rtems_id tid;
+    int test; // index, or -1 if idle
+    // set by the worker, before signaling the runner
+    volatile bool finished;
+    volatile bool exited;
+};
+
+struct test_runner {
+    const struct test_runner_test *tests;
+    size_t n;
+    rtems_id tid;
+    enum test_state states[TEST_RUNNER_TESTS_MAX];
+    int rcs[TEST_RUNNER_TESTS_MAX];
+    uint64_t ns[TEST_RUNNER_TESTS_MAX];
+    struct test_worker workers[TEST_RUNNER_WORKERS_MAX];
+    uint32_t n_workers;
+};
+
+static rtems_task test_worker_task(rtems_task_argument arg)
+{
+    struct test_worker *w = (struct test_worker *)arg;
+    struct test_runner *r = w->runner;
+    rtems_event_set events;
+    uint64_t start;
+    int i;
+    while (1) {
+        rtems_event_receive(TEST_RUNNER_EVENT_RUN | TEST_RUNNER_EVENT_EXIT,
+                            RTEMS_EVENT_ANY, RTEMS_NO_TIMEOUT, &events);
+        if (events & TEST_RUNNER_EVENT_EXIT)
+            break;
+        i = w->test;
+        start = rtems_clock_get_uptime_nanoseconds();
+        r->rcs[i] = r->tests[i].fn();
+        r->ns[i] = rtems_clock_get_uptime_nanoseconds() - start;
+        w->finished = true;
+        rtems_event_send(r->tid, TEST_RUNNER_EVENT_DONE);
+    }
+    w->exited = true;
+    rtems_event_send(r->tid, TEST_RUNNER_EVENT_DONE);
+    rtems_task_exit();
+}
+
+// Returns the state of the test's dependencies: PASSED if all passed, FAILED
+// if any failed or was skipped, else PENDING.
+static enum test_state test_runner_deps(struct test_runner *r, size_t i)
+{
+    enum test_state state = TEST_STATE_PASSED;
+    const char *dep;
+    size_t d;
+    size_t j;
+    for (d = 0; d < TEST_RUNNER_DEPS_MAX; d++) {
+        dep = r->tests[i].deps[d];
+        if (!dep)
+            continue;
+        for (j = 0; j < r->n; j++) {
+            if (strcmp(r->tests[j].name, dep))
+                continue;
+            if (r->states[j] == TEST_STATE_FAILED ||
+                r->states[j] == TEST_STATE_SKIPPED)
+                return TEST_STATE_FAILED;
+            if (r->states[j] != TEST_STATE_PASSED)
+                state = TEST_STATE_PENDING;
+        }
+    }
+    return state;
+}
+
+// Skips tests whose dependencies failed, transitively.
+static void test_runner_skip(struct test_runner *r)
+{
+    bool changed;
+    size_t i;
+    do {
+        changed = false;
+        for (i = 0; i < r->n; i++) {
+            if (r->states[i] == TEST_STATE_PENDING &&
+                test_runner_deps(r, i) == TEST_STATE_FAILED) {
+                r->states[i] = TEST_STATE_SKIPPED;
+                changed = true;
+            }
+        }
+    } while (changed);
+}
+
+// Returns a test that may start now, or -1.
+static int test_runner_next(struct test_runner *r, uint32_t busy)
+{
+    size_t i;
+    for (i = 0; i < r->n; i++) {
+        if (r->states[i] == TEST_STATE_PENDING &&
+            !(r->tests[i].resources & busy) &&
+            test_runner_deps(r, i) == TEST_STATE_PASSED)
+            return i;
+    }
+    return -1;
+}
+
+static void test_runner_dispatch(struct test_runner *r)
+{
+    struct test_worker *w;
+    uint32_t busy = 0;
+    unsigned running = 0;
+    rtems_event_set events;
+    uint32_t k;
+    int i;
+    while (1) {
+        for (k = 0; k < r->n_workers; k++) {
+            w = &r->workers[k];
+            if (w->test >= 0 && w->finished) {
+                r->states[w->test] = r->rcs[w->test] ? TEST_STATE_FAILED :
+                                                       TEST_STATE_PASSED;
+                busy &= ~r->tests[w->test].resources;
+                w->test = -1;
+                running--;
+            }
+        }
+        test_runner_skip(r);
+        for (k = 0; k < r->n_workers; k++) {
+            w = &r->workers[k];
+            if (w->test >= 0)
+                continue;
+            i = test_runner_next(r, busy);
+            if (i < 0)
+                break;
+            r->states[i] = TEST_STATE_RUNNING;
+            busy |= r->tests[i].resources;
+            running++;
+            w->finished = false;
+            w->test = i;
+            rtems_event_send(w->tid, TEST_RUNNER_EVENT_RUN);
+        }
+        // nothing left, or only tests in a dependency cycle
+        if (!running)
+            break;
+        rtems_event_receive(TEST_RUNNER_EVENT_DONE, RTEMS_EVENT_ANY,
+                            RTEMS_NO_TIMEOUT, &events);
+    }
+    for (i = 0; (size_t) i < r->n; i++)
+        if (r->states[i] == TEST_STATE_PENDING)
+            r->states[i] = TEST_STATE_SKIPPED;
+}
+
+static void test_runner_workers_stop(struct test_runner *r)
+{
+    rtems_event_set events;
+    uint32_t k;
+    for (k = 0; k < r->n_workers; k++)
+        rtems_event_send(r->workers[k].tid, TEST_RUNNER_EVENT_EXIT);
+    for (k = 0; k < r->n_workers; k++)
+        while (!r->workers[k].exited)
+            rtems_event_receive(TEST_RUNNER_EVENT_DONE, RTEMS_EVENT_ANY,
+                                RTEMS_NO_TIMEOUT, &events);
+}
+
+static rtems_status_code test_runner_workers_start(struct test_runner *r,
+                                                   rtems_task_priority priority)
+{
+    struct test_worker *w;
+    rtems_status_code sc = RTEMS_SUCCESSFUL;
+    uint32_t n = rtems_get_processor_count();
+    uint32_t k;
+    if (n > TEST_RUNNER_WORKERS_MAX)
+        n = TEST_RUNNER_WORKERS_MAX;
+    r->n_workers = 0;
+    for (k = 0; k < n; k++) {
+        w = &r->workers[k];
+        w->runner = r;
+        w->test = -1;
+        w->finished = false;
+        w->exited = false;
+        sc = rtems_task_create(
+            rtems_build_name('T','S','T',k), priority,
+            RTEMS_MINIMUM_STACK_SIZE * 4, RTEMS_DEFAULT_MODES,
+            RTEMS_DEFAULT_ATTRIBUTES, &w->tid
+        );
+        if (sc != RTEMS_SUCCESSFUL)
+            break;
+        // spread the tests across CPUs
+        sc = affinity_pin_to_cpu(w->tid, k);
+        if (sc == RTEMS_SUCCESSFUL)
+            sc = rtems_task_start(w->tid, test_worker_task,
+                                  (rtems_task_argument)w);
+        if (sc != RTEMS_SUCCESSFUL) {
+            rtems_task_delete(w->tid);
+            break;
+        }
+        r->n_workers++;
+    }
+    if (sc != RTEMS_SUCCESSFUL)
+        test_runner_workers_stop(r);
+    return sc;
+}
+
+int test_runner_run(const struct test_runner_test *tests, size_t n,
+                    rtems_task_priority priority)
+{
+    // too big for the stack
+    static struct test_runner runner;
+    struct test_runner *r = &runner;
+    unsigned counts[RTEMS_ARRAY_SIZE(test_state_strs)] = { 0 };
+    uint64_t start;
+    size_t i;
+    assert(tests || !n);
+    assert(n <= TEST_RUNNER_TESTS_MAX);
+
+    memset(r, 0, sizeof(*r));
+    r->tests = tests;
+    r->n = n;
+    r->tid = rtems_task_self();
+    if (test_runner_workers_start(r, priority) != RTEMS_SUCCESSFUL)
+        return -1;
+    start = rtems_clock_get_uptime_nanoseconds();
+    test_runner_dispatch(r);
+    test_runner_workers_stop(r);
+
+    for (i = 0; i < n; i++) {
+        counts[r->states[i]]++;
+        printk("TEST: %s: %s: %"PRIu64" us\n", tests[i].name,
+               test_state_strs[r->states[i]], r->ns[i] / 1000);
+    }
+    printk("TEST: %u passed, %u failed, %u skipped: %"PRIu64" us on %"PRIu32
+           " CPUs\n", counts[TEST_STATE_PASSED], counts[TEST_STATE_FAILED],
+           counts[TEST_STATE_SKIPPED],
+           (rtems_clock_get_uptime_nanoseconds() - start) / 1000,
+           r->n_workers);
+    return counts[TEST_STATE_FAILED] + counts[TEST_STATE_SKIPPED];
+}
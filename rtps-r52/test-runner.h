@@ -0,0 +1,35 @@
+#ifndef TEST_RUNNER_H
+#define TEST_RUNNER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rtems.h>
+
+// Runs independent tests concurrently, on a worker task per CPU.
+// A test starts once all of its dependencies passed and none of its resources
+// are used by a running test. Tests must not share unlisted resources, e.g.,
+// the events of the task they run on, other than through their own waits.
+
+#define TEST_RUNNER_TESTS_MAX 32
+#define TEST_RUNNER_DEPS_MAX 2
+#define TEST_RUNNER_WORKERS_MAX 4
+
+struct test_runner_test {
+    const char *name;
+    int (*fn)(void); // returns 0 on success
+    uint32_t resources; // a bit per resource, used exclusively
+    // names of tests that must pass first, names not in the run are ignored
+    const char *deps[TEST_RUNNER_DEPS_MAX];
+};
+
+/**
+ * Run tests on worker tasks at a priority, printing each test's result and
+ * duration, and a summary. Tests with failed dependencies are skipped.
+ * Returns the number of tests that failed or were skipped, or -1 if the
+ * workers couldn't be created.
+ */
+int test_runner_run(const struct test_runner_test *tests, size_t n,
+                    rtems_task_priority priority);
+
+#endif // TEST_RUNNER_H
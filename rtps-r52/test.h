@@ -17,16 +17,24 @@
 // Standalone
 int test_command(void);
 int test_cpu_rti_timers(void);
+int test_file_xfer(void);
+int test_health(void);
 int test_lsio_sram(void);
 int test_lsio_sram_dma(void);
 int test_mbox_lsio_loopback(void);
+int test_mem_access(void);
+int test_prop_store(void);
+int test_telemetry(void);
 int test_rtps_dma(void); // wrapped by test_rtps_mmu
 int test_rtps_mmu(bool do_dma_test);
 int test_shmem(void);
+int test_shmem_arena(void);
+int test_shmem_bcast(void);
 
 // Local runtime
 int test_command_server(void);
 int test_link_shmem(void);
+int test_link_shmem_doorbell(void);
 
 // Externally dependent
 int test_link_mbox_trch(void);
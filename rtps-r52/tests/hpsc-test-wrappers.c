@@ -1,6 +1,16 @@
+#include <assert.h>
+#include <sched.h>
+
+#include <rtems.h>
+
+// libhpsc
+#include <affinity.h>
+#include <doorbell.h>
+
 // libhpsc-test
 #include <hpsc-test.h>
 
+#include "doorbell-sgi.h"
 #include "test.h"
 
 int test_command(void)
@@ -21,6 +31,69 @@ int test_shmem(void)
     return rc;
 }
 
+int test_shmem_arena(void)
+{
+    int rc;
+    test_begin("test_shmem_arena");
+    rc = hpsc_test_shmem_arena();
+    test_end("test_shmem_arena", rc);
+    return rc;
+}
+
+int test_file_xfer(void)
+{
+    int rc;
+    test_begin("test_file_xfer");
+    rc = hpsc_test_file_xfer();
+    test_end("test_file_xfer", rc);
+    return rc;
+}
+
+int test_health(void)
+{
+    int rc;
+    test_begin("test_health");
+    rc = hpsc_test_health();
+    test_end("test_health", rc);
+    return rc;
+}
+
+int test_telemetry(void)
+{
+    int rc;
+    test_begin("test_telemetry");
+    rc = hpsc_test_telemetry();
+    test_end("test_telemetry", rc);
+    return rc;
+}
+
+int test_prop_store(void)
+{
+    int rc;
+    test_begin("test_prop_store");
+    rc = hpsc_test_prop_store();
+    test_end("test_prop_store", rc);
+    return rc;
+}
+
+int test_mem_access(void)
+{
+    int rc;
+    test_begin("test_mem_access");
+    rc = hpsc_test_mem_access();
+    test_end("test_mem_access", rc);
+    return rc;
+}
+
+int test_shmem_bcast(void)
+{
+    int rc;
+    test_begin("test_shmem_bcast");
+    rc = hpsc_test_shmem_bcast();
+    test_end("test_shmem_bcast", rc);
+    return rc;
+}
+
 int test_command_server(void)
 {
     int rc;
@@ -43,3 +116,45 @@ int test_link_shmem(void)
     test_end("test_link_shmem", rc);
     return rc;
 }
+
+// SGIs 0-7 are left for RTEMS (e.g., SMP inter-processor interrupts)
+#define SGI_LINK_SHMEM_TEST_SERVER 8
+#define SGI_LINK_SHMEM_TEST_CLIENT 9
+int test_link_shmem_doorbell(void)
+{
+    struct doorbell *sdb;
+    struct doorbell *cdb;
+    cpu_set_t cpuset;
+    rtems_status_code sc RTEMS_UNUSED;
+    uint32_t cpu;
+    int rc = 1;
+    test_begin("test_link_shmem_doorbell");
+
+    // SGI handlers are enabled per-CPU, so stay on one CPU for the test
+    sc = rtems_task_get_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
+    assert(sc == RTEMS_SUCCESSFUL);
+    cpu = rtems_get_current_processor();
+    affinity_pin_self_to_cpu(cpu);
+
+    // each side rings the other's listening vector
+    sdb = doorbell_sgi_open("Shmem Link Test Server Doorbell",
+                            SGI_LINK_SHMEM_TEST_CLIENT,
+                            SGI_LINK_SHMEM_TEST_SERVER, 1 << cpu);
+    if (!sdb)
+        goto out;
+    cdb = doorbell_sgi_open("Shmem Link Test Client Doorbell",
+                            SGI_LINK_SHMEM_TEST_SERVER,
+                            SGI_LINK_SHMEM_TEST_CLIENT, 1 << cpu);
+    if (!cdb) {
+        doorbell_close(sdb);
+        goto out;
+    }
+    rc = hpsc_test_link_shmem_doorbell(sdb, cdb, SHMEM_WTIMEOUT_TICKS,
+                                       SHMEM_RTIMEOUT_TICKS, SHMEM_EVENT_WAIT);
+
+out:
+    sc = rtems_task_set_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
+    assert(sc == RTEMS_SUCCESSFUL);
+    test_end("test_link_shmem_doorbell", rc);
+    return rc;
+}
@@ -4,19 +4,35 @@
 
 #include <rtems.h>
 #include <rtems/bspIo.h>
+#include <rtems/shell.h>
 #include <bsp/hpsc-wdt.h>
+#include <bsp/hwinfo.h>
 
 // libhpsc
 #include <affinity.h>
 #include <devices.h>
+#include <health.h>
 #include <watchdog-cpu.h>
 
+#include "notify.h"
 #include "watchdog.h"
 
 // TODO: get this interval dynamically (e.g., from device tree)
 // The WDT has a 1 second first stage timeout by default
 #define WDT_KICK_INTERVAL_TICKS RTEMS_MICROSECONDS_TO_TICKS(500000)
+#define WDT_KICK_INTERVAL_NS 500000000
 
+#if CONFIG_WDT_KICK_RTIT && !CONFIG_RTI_TIMER
+#error CONFIG_WDT_KICK_RTIT requires CONFIG_RTI_TIMER
+#endif
+
+static struct health_group health_groups[CPU_MAXIMUM_PROCESSORS];
+
+struct health_group *watchdog_health(uint32_t cpu)
+{
+    assert(cpu < CPU_MAXIMUM_PROCESSORS);
+    return &health_groups[cpu];
+}
 
 static void watchdog_timeout_isr(void *arg)
 {
@@ -24,9 +40,62 @@ static void watchdog_timeout_isr(void *arg)
     assert(wdt);
     wdt_timeout_clear(wdt, 0);
     printk("watchdog: expired\n");
+    // the WDT interrupt is private to the CPU that failed to kick it
+    notify_wdt_timeout(rtems_get_current_processor());
     // TODO: the WDT task failed to kick - maybe initiate a graceful shutdown
 }
 
+#if CONFIG_WDT_KICK_RTIT
+// The RTI timer interrupt is a PPI, so is installed from each CPU in turn.
+static void watchdog_timers_start(void)
+{
+    cpu_set_t cpuset;
+    rtems_status_code sc RTEMS_UNUSED;
+    uint32_t cpu;
+
+    // store CPU affinity before CPU-specific operations
+    sc = rtems_task_get_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
+    assert(sc == RTEMS_SUCCESSFUL);
+
+    dev_cpu_for_each(cpu) {
+        printf("Watchdog timer: start: %"PRIu32"\n", cpu);
+        affinity_pin_self_to_cpu(cpu);
+        sc = watchdog_cpu_timer_start(dev_cpu_get_wdt(), watchdog_health(cpu),
+                                      dev_cpu_get_rtit(), WDT_KICK_INTERVAL_NS,
+                                      watchdog_timeout_isr, dev_cpu_get_wdt());
+        if (sc != RTEMS_SUCCESSFUL)
+            rtems_panic("watchdog_timers_start: watchdog_cpu_timer_start");
+    }
+
+    // restore CPU affinity
+    sc = rtems_task_set_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
+    assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void watchdog_timers_stop(void)
+{
+    cpu_set_t cpuset;
+    rtems_status_code sc RTEMS_UNUSED;
+    uint32_t cpu;
+
+    // store CPU affinity before CPU-specific operations
+    sc = rtems_task_get_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
+    assert(sc == RTEMS_SUCCESSFUL);
+
+    dev_cpu_for_each(cpu) {
+        printf("Watchdog timer: stop: %"PRIu32"\n", cpu);
+        affinity_pin_self_to_cpu(cpu);
+        sc = watchdog_cpu_timer_stop(RTI_MAX_COUNT);
+        // RTEMS_NOT_DEFINED means no timer was kicking
+        if (sc != RTEMS_SUCCESSFUL && sc != RTEMS_NOT_DEFINED)
+            rtems_panic("watchdog_timers_stop: watchdog_cpu_timer_stop");
+    }
+
+    // restore CPU affinity
+    sc = rtems_task_set_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
+    assert(sc == RTEMS_SUCCESSFUL);
+}
+#else
 static void watchdog_task_create(
     rtems_task_priority priority,
     struct HPSC_WDT_Config *wdt,
@@ -44,57 +113,73 @@ static void watchdog_task_create(
         RTEMS_DEFAULT_ATTRIBUTES, &task_id
     );
     assert(sc == RTEMS_SUCCESSFUL);
-    // pin watchdog task to its CPU
+    // pin watchdog task to its CPU, where it sets up the WDT
     sc = affinity_pin_to_cpu(task_id, cpu);
     assert(sc == RTEMS_SUCCESSFUL);
-    sc = watchdog_cpu_task_start(wdt, task_id, WDT_KICK_INTERVAL_TICKS,
+    sc = watchdog_cpu_task_start(cpu, wdt, watchdog_health(cpu), task_id,
+                                 WDT_KICK_INTERVAL_TICKS,
                                  watchdog_timeout_isr, wdt);
     if (sc != RTEMS_SUCCESSFUL)
         rtems_panic("watchdog_task_create: watchdog_cpu_task_start");
 }
+#endif // CONFIG_WDT_KICK_RTIT
 
-void watchdog_tasks_create(rtems_task_priority priority)
+void watchdog_tasks_create(rtems_task_priority priority RTEMS_UNUSED)
 {
-    cpu_set_t cpuset;
-    rtems_status_code sc RTEMS_UNUSED;
+#if CONFIG_WDT_KICK_RTIT
+    watchdog_timers_start();
+#else
     uint32_t cpu;
-
-    // store CPU affinity before CPU-specific operations
-    sc = rtems_task_get_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
-    assert(sc == RTEMS_SUCCESSFUL);
-
     dev_cpu_for_each(cpu) {
         printf("Watchdog task: start: %"PRIu32"\n", cpu);
-        // pin so we can get device handle
-        affinity_pin_self_to_cpu(cpu);
-        watchdog_task_create(priority, dev_cpu_get_wdt(), cpu);
+        watchdog_task_create(priority, dev_cpu_get_wdt_for(cpu), cpu);
     }
-
-    // restore CPU affinity
-    sc = rtems_task_set_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
-    assert(sc == RTEMS_SUCCESSFUL);
+#endif // CONFIG_WDT_KICK_RTIT
 }
 
 void watchdog_tasks_destroy(void)
 {
-    cpu_set_t cpuset;
-    rtems_status_code sc RTEMS_UNUSED;
+#if CONFIG_WDT_KICK_RTIT
+    watchdog_timers_stop();
+#else
+    rtems_status_code sc;
     uint32_t cpu;
-
-    // store CPU affinity before CPU-specific operations
-    sc = rtems_task_get_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
-    assert(sc == RTEMS_SUCCESSFUL);
-
     dev_cpu_for_each(cpu) {
         printf("Watchdog task: stop: %"PRIu32"\n", cpu);
-        affinity_pin_self_to_cpu(cpu);
-        sc = watchdog_cpu_task_stop();
+        sc = watchdog_cpu_task_stop(cpu);
         // RTEMS_NOT_DEFINED means no task was running
         if (sc != RTEMS_SUCCESSFUL && sc != RTEMS_NOT_DEFINED)
             rtems_panic("watchdog_tasks_destroy: watchdog_cpu_task_stop");
     }
+#endif // CONFIG_WDT_KICK_RTIT
+}
 
-    // restore CPU affinity
-    sc = rtems_task_set_affinity(RTEMS_SELF, sizeof(cpuset), &cpuset);
-    assert(sc == RTEMS_SUCCESSFUL);
+static int watchdog_health_print(int argc RTEMS_UNUSED,
+                                 char *argv[] RTEMS_UNUSED)
+{
+    struct health_stats stats[HEALTH_TASKS_MAX];
+    size_t n;
+    size_t i;
+    uint32_t cpu;
+    dev_cpu_for_each(cpu) {
+        n = health_get_stats(watchdog_health(cpu), stats, HEALTH_TASKS_MAX);
+        for (i = 0; i < n; i++)
+            printf("cpu %"PRIu32": %s: period %"PRIu32" ticks: "
+                   "min slack %"PRId32": misses %"PRIu32"\n", cpu,
+                   stats[i].name, stats[i].period, stats[i].min_slack,
+                   stats[i].misses);
+    }
+    return 0;
 }
+
+rtems_shell_cmd_t watchdog_health_command = {
+    "health",                                  /* name */
+    "health",                                  /* usage */
+    "hpsc-rtps-r52",                           /* topic */
+    watchdog_health_print,                     /* command */
+    NULL,                                      /* alias */
+    NULL,                                      /* next */
+    0,                                         /* mode */
+    0,                                         /* uid */
+    0                                          /* gid */
+};
@@ -2,9 +2,21 @@
 #define WATCHDOG_H
 
 #include <rtems.h>
+#include <rtems/shell.h>
 
+// libhpsc
+#include <health.h>
+
+// Each CPU's WDT is kicked only while all tasks registered in its health group
+// check in on time.
+struct health_group *watchdog_health(uint32_t cpu);
+
+// With CONFIG_WDT_KICK_RTIT, each CPU's RTI timer kicks its WDT instead of a
+// task (and the priority is unused), so the timers aren't free for other uses.
 void watchdog_tasks_create(rtems_task_priority priority);
 
 void watchdog_tasks_destroy(void);
 
+extern rtems_shell_cmd_t watchdog_health_command;
+
 #endif // WATCHDOG_H